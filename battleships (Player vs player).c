@@ -1,31 +1,33 @@
-#include <stdio.h>
-#include <stdlib.h>
+#include "battleships.h"
 
-#define GRID_SIZE 8
-#define NUM_SHIPS 5
+// Built against the 8x8 engine with five single-cell ships (BOARD_SIZE=8,
+// FLEET=1,1,1,1,1). The engine's board symbols are shown as this game's own:
+// '`' water, 'S' ship, 'X' hit, '*' miss.
+typedef Board Grid;
 
 // Function prototypes
-void initializeGrid(char grid[GRID_SIZE][GRID_SIZE]);
-void displayGrid(char grid[GRID_SIZE][GRID_SIZE], int revealShips);
-void placeShips(char grid[GRID_SIZE][GRID_SIZE]);
-int makeMove(char grid[GRID_SIZE][GRID_SIZE], int row, int col);
-int isGameOver(char grid[GRID_SIZE][GRID_SIZE]);
+void initializeGrid(Grid *grid);
+void displayGrid(const Grid *grid, int revealShips);
+void placeShips(Grid *grid);
+int makeMove(Grid *grid, int row, int col);
+int isGameOver(const Grid *grid);
 
 int main() {
-    char player1Grid[GRID_SIZE][GRID_SIZE];
-    char player2Grid[GRID_SIZE][GRID_SIZE];
+    engine_init();
+    Grid player1Grid;
+    Grid player2Grid;
     int row, col, result;
     int currentPlayer = 1;
 
     // Places the grids
-    initializeGrid(player1Grid);
-    initializeGrid(player2Grid);
+    initializeGrid(&player1Grid);
+    initializeGrid(&player2Grid);
 
     // Players place the ships
     printf("Player 1, place your ships:\n");
-    placeShips(player1Grid);
+    placeShips(&player1Grid);
     printf("Player 2, place your ships:\n");
-    placeShips(player2Grid);
+    placeShips(&player2Grid);
 
     printf("\nWelcome to 2-Player Battleships!\n");
     printf("Players take turns attacking each other.\n");
@@ -34,10 +36,10 @@ int main() {
         printf("\nPlayer %d's Turn:\n", currentPlayer);
         if (currentPlayer == 1) {
             printf("Opponent's Grid:\n");
-            displayGrid(player2Grid, 0);
+            displayGrid(&player2Grid, 0);
         } else {
             printf("Opponent's Grid:\n");
-            displayGrid(player1Grid, 0);
+            displayGrid(&player1Grid, 0);
         }
 
         // Player's turn to attack
@@ -47,15 +49,15 @@ int main() {
         col = colChar - 'A';
         row -= 1;
 
-        if (row < 0 || row >= GRID_SIZE || col < 0 || col >= GRID_SIZE) {
+        if (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE) {
             printf("Bro those are invalid coords use your brain.\n");
             continue;
         }
 
         if (currentPlayer == 1) {
-            result = makeMove(player2Grid, row, col);
+            result = makeMove(&player2Grid, row, col);
         } else {
-            result = makeMove(player1Grid, row, col);
+            result = makeMove(&player1Grid, row, col);
         }
 
         if (result == 1) {
@@ -67,10 +69,10 @@ int main() {
             continue;
         }
 
-        if (currentPlayer == 1 && isGameOver(player2Grid)) {
+        if (currentPlayer == 1 && isGameOver(&player2Grid)) {
             printf("\nCongratulations, Player 1! You destroyed all enemy ships!\n");
             break;
-        } else if (currentPlayer == 2 && isGameOver(player1Grid)) {
+        } else if (currentPlayer == 2 && isGameOver(&player1Grid)) {
             printf("\nCongratulations, Player 2! You destroyed all enemy ships!\n");
             break;
         }
@@ -81,42 +83,51 @@ int main() {
 
     printf("\nFinal Grids:\n");
     printf("Player 1's Grid:\n");
-    displayGrid(player1Grid, 1);
+    displayGrid(&player1Grid, 1);
     printf("Player 2's Grid:\n");
-    displayGrid(player2Grid, 1);
+    displayGrid(&player2Grid, 1);
 
     return 0;
 }
 
-void initializeGrid(char grid[GRID_SIZE][GRID_SIZE]) {
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            grid[i][j] = '`';
-        }
-    }
+void initializeGrid(Grid *grid) {
+    initialize_board(grid);
 }
 
-void displayGrid(char grid[GRID_SIZE][GRID_SIZE], int revealShips) {
-    printf("  ");
-    for (char c = 'A'; c < 'A' + GRID_SIZE; c++) {
-        printf("%c ", c);
+// Formats the whole grid into one buffer and hands it to stdio in a single call,
+// so it reaches the terminal in one write instead of one per cell.
+void displayGrid(const Grid *grid, int revealShips) {
+    char out[(BOARD_SIZE + 1) * (2 * BOARD_SIZE + 8)];
+    int length = 0;
+    out[length++] = ' ';
+    out[length++] = ' ';
+    for (char c = 'A'; c < 'A' + BOARD_SIZE; c++) {
+        out[length++] = c;
+        out[length++] = ' ';
     }
-    printf("\n");
-
-    for (int i = 0; i < GRID_SIZE; i++) {
-        printf("%d ", i + 1);
-        for (int j = 0; j < GRID_SIZE; j++) {
-            if (grid[i][j] == 'S' && !revealShips) {
-                printf("` ");
-            } else {
-                printf("%c ", grid[i][j]);
+    out[length++] = '\n';
+
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        length += sprintf(out + length, "%d ", i + 1);
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            switch (board_symbol(grid, i, j)) {
+            case '&': out[length++] = revealShips ? 'S' : '`'; break;
+            case '#':
+            case '0': out[length++] = 'X'; break;
+            case 'x': out[length++] = '*'; break;
+            default:  out[length++] = '`'; break;
             }
+            out[length++] = ' ';
         }
-        printf("\n");
+        out[length++] = '\n';
     }
+
+    fflush(stdout);
+    fwrite(out, 1, length, stdout);
+    fflush(stdout);
 }
 
-void placeShips(char grid[GRID_SIZE][GRID_SIZE]) {
+void placeShips(Grid *grid) {
     int shipsPlaced = 0;
     int row, col;
     char colChar;
@@ -127,13 +138,12 @@ void placeShips(char grid[GRID_SIZE][GRID_SIZE]) {
         col = colChar - 'A';
         row -= 1;
 
-        if (row < 0 || row >= GRID_SIZE || col < 0 || col >= GRID_SIZE) {
+        if (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE) {
             printf("Cant place here lil bro. Place it somewhere in the grid na.\n");
             continue;
         }
 
-        if (grid[row][col] == '`') {
-            grid[row][col] = 'S';
+        if (place_ship(grid, SHIP_SIZES[shipsPlaced], true, row, col)) {
             shipsPlaced++;
         } else {
             printf("A ship is placed here dummy. Try again somewhere else you stopid bro.\n");
@@ -141,24 +151,12 @@ void placeShips(char grid[GRID_SIZE][GRID_SIZE]) {
     }
 }
 
-int makeMove(char grid[GRID_SIZE][GRID_SIZE], int row, int col) {
-    if (grid[row][col] == 'S') {
-        grid[row][col] = 'X';
-        return 1; // Hit
-    } else if (grid[row][col] == '`') {
-        grid[row][col] = '*';
-        return 0; // Miss
-    }
-    return -1; // Already attacked
+int makeMove(Grid *grid, int row, int col) {
+    if (is_attacked(grid, row, col))
+        return -1; // Already attacked
+    return process_attack(grid, row, col) != ATTACK_MISS; // 1 for a hit, 0 for a miss
 }
 
-int isGameOver(char grid[GRID_SIZE][GRID_SIZE]) {
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            if (grid[i][j] == 'S') {
-                return 0; // Ships still remain
-            }
-        }
-    }
-    return 1; // All ships are destroyed now go home you code inspector
+int isGameOver(const Grid *grid) {
+    return check_victory(grid); // All ships are destroyed now go home you code inspector
 }
@@ -0,0 +1,548 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "battleships.h"
+
+// -----------------------------------------------------------------------------
+// Protocol
+// -----------------------------------------------------------------------------
+
+// One process serves every game. Each connection is one player vs nightmare AI
+// session, driven by a line protocol (commands are case-sensitive, cells are
+// written as on the board, e.g. B7):
+//
+//   server: READY <board size> <ship sizes...>   new game, both fleets random
+//   client: FIRE <cell>
+//   server: HIT <cell> | MISS <cell>, then SUNK <size> if a ship went down,
+//           then WIN, or the computer's shot as AI HIT/MISS <cell> (and
+//           AI SUNK <size>), then LOSE if that was the last of your ships
+//   client: BOARD
+//   server: ROW <n> <your row> <your view of the opponent's row>, one per row,
+//           then END (same symbols as the terminal game)
+//   client: NEW      starts another game (READY again)
+//   client: QUIT     closes the connection
+//   server: ERR <reason> for anything it cannot do
+// Commands are short; anything longer than MAX_LINE - 1 characters is cut off
+// and rejected as unknown.
+#define MAX_LINE 24
+#define OUTPUT_BUFFER 8192
+#define MAX_PENDING 65536
+#define MAX_EVENTS 256
+#define SESSIONS_PER_SLAB 4096
+
+// -----------------------------------------------------------------------------
+// Sessions
+// -----------------------------------------------------------------------------
+
+// Memory per idle session is what limits how many clients one server can hold,
+// so a session keeps its game packed (see PackedGame) and only a partial
+// command line. Commands are run on one shared, unpacked Game, and replies go
+// through one shared output buffer; a session only gets a buffer of its own
+// while the client is not reading fast enough to take its replies. Sessions
+// come from a pool, so connecting and disconnecting does not call malloc once
+// the pool has grown.
+typedef struct {
+    PackedGame game;         // The client is player 1, the computer player 2.
+    char *pending;           // Replies the socket has not taken yet, or NULL.
+    unsigned pending_length;
+    int fd;
+    bool closing;            // QUIT received; close once the replies are out.
+    bool writing;            // Registered for EPOLLOUT.
+    unsigned char input_length;
+    char input[MAX_LINE];    // Command line received so far.
+} Session;
+
+static uint64_t server_seed;
+static long sessions_started;
+static Pool session_pool;
+
+// When the process runs out of file descriptors, pending connections are
+// accepted into the spare descriptor's slot and closed at once; if even that
+// fails, the listening socket leaves epoll until a session closes.
+static int listen_socket;
+static int spare_fd = -1;
+static bool accept_paused;
+static bool out_of_fds;  // Reported once until a connection is accepted again.
+
+// The game a command runs on, unpacked from the session and packed again after.
+// Its strategy state is allocated once, in main(), and reset in place for each
+// command.
+static Game current;
+
+// Replies to the commands being handled, before they are sent.
+static char output[OUTPUT_BUFFER];
+static size_t output_length;
+static bool output_overflowed;
+
+// Function prototypes
+static void reply(const char *format, ...) __attribute__((format(printf, 1, 2)));
+static void start_game(Session *session);
+static void handle_line(Session *session, char *line);
+static bool deliver_output(Session *session);
+
+// -----------------------------------------------------------------------------
+// Session Observer
+// -----------------------------------------------------------------------------
+
+// Game events become protocol lines. The client's own shots are reported with
+// PLAYER_NAME as the shooter; anything else is the computer.
+#define PLAYER_NAME "You"
+
+static const char *shot_prefix(const char *shooter) {
+    return strcmp(shooter, PLAYER_NAME) == 0 ? "" : "AI ";
+}
+
+static void session_hit(void *context, const char *shooter, int x, int y) {
+    (void)context;
+    reply("%sHIT %c%d\n", shot_prefix(shooter), ALPHABET[y], x + 1);
+}
+
+static void session_miss(void *context, const char *shooter, int x, int y) {
+    (void)context;
+    reply("%sMISS %c%d\n", shot_prefix(shooter), ALPHABET[y], x + 1);
+}
+
+static void session_sink(void *context, const char *shooter, int x, int y, int size) {
+    (void)context;
+    (void)x;
+    (void)y;
+    reply("%sSUNK %d\n", shot_prefix(shooter), size);
+}
+
+static void session_victory(void *context, const char *winner) {
+    (void)context;
+    reply(strcmp(winner, PLAYER_NAME) == 0 ? "WIN\n" : "LOSE\n");
+}
+
+static const GameObserver SESSION_OBSERVER = {
+    NULL, NULL, session_hit, session_miss, session_sink, session_victory
+};
+
+// -----------------------------------------------------------------------------
+// Game Handling
+// -----------------------------------------------------------------------------
+
+static void reply(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(output + output_length, OUTPUT_BUFFER - output_length, format, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= OUTPUT_BUFFER - output_length) {
+        output_overflowed = true;
+        return;
+    }
+    output_length += (size_t)n;
+}
+
+// Seeds each game from the server seed and a running game number, so a server
+// started with --seed deals the same fleets in the same order.
+static void start_game(Session *session) {
+    game_restart(&current, server_seed ^ ((uint64_t)sessions_started++ * 0xD1B54A32D192ED03ULL));
+    place_ships_random(&current.players[0].fleet, &current.rng);
+    game_pack(&current, &session->game);
+    reply("READY %d", BOARD_SIZE);
+    for (int i = 0; i < NUM_SHIPS; i++)
+        reply(" %d", SHIP_SIZES[i]);
+    reply("\n");
+}
+
+// The client's shot, then the computer's reply unless the client just won.
+static void fire(Session *session, const char *cell) {
+    int x, y;
+    if (!parse_cell(cell, &x, &y)) {
+        reply("ERR invalid cell\n");
+        return;
+    }
+    game_unpack(&session->game, &current, PLAYER_NAME, "Computer");
+    switch (game_submit_move(&current, x, y, &SESSION_OBSERVER)) {
+    case MOVE_ACCEPTED:
+        while (game_advance(&current, &SESSION_OBSERVER))
+            ;
+        game_pack(&current, &session->game);
+        break;
+    case MOVE_INVALID:
+        reply("ERR invalid cell\n");
+        break;
+    case MOVE_REPEATED:
+        reply("ERR already attacked\n");
+        break;
+    case MOVE_NOT_ALLOWED:
+        reply("ERR game over, send NEW\n");
+        break;
+    }
+}
+
+static void send_board(Session *session) {
+    const GamePlayer *player = &current.players[0];
+    char own[MAX_BOARD_SIZE + 1], enemy[MAX_BOARD_SIZE + 1];
+    game_unpack_boards(&session->game, &current);
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            own[j] = board_symbol(&player->fleet, i, j);
+            enemy[j] = board_symbol(&player->guess, i, j);
+        }
+        own[BOARD_SIZE] = enemy[BOARD_SIZE] = '\0';
+        reply("ROW %d %s %s\n", i + 1, own, enemy);
+    }
+    reply("END\n");
+}
+
+static void handle_line(Session *session, char *line) {
+    size_t length = strlen(line);
+    if (length > 0 && line[length - 1] == '\r')
+        line[--length] = '\0';
+    if (strncmp(line, "FIRE ", 5) == 0)
+        fire(session, line + 5);
+    else if (strcmp(line, "BOARD") == 0)
+        send_board(session);
+    else if (strcmp(line, "NEW") == 0)
+        start_game(session);
+    else if (strcmp(line, "QUIT") == 0)
+        session->closing = true;
+    else if (length > 0)
+        reply("ERR unknown command\n");
+}
+
+// -----------------------------------------------------------------------------
+// Connections
+// -----------------------------------------------------------------------------
+
+// Sends as much of `data` as the socket takes and returns how much that was,
+// or -1 if the connection failed.
+static ssize_t send_some(int fd, const char *data, size_t length) {
+    size_t sent = 0;
+    while (sent < length) {
+        ssize_t n = send(fd, data + sent, length - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (n <= 0)
+            return -1;
+        sent += (size_t)n;
+    }
+    return (ssize_t)sent;
+}
+
+// Hands the shared output to the session: straight to the socket if nothing is
+// queued before it, and whatever the socket does not take into the session's
+// pending buffer. Returns false if the connection failed or the client has
+// stopped reading.
+static bool deliver_output(Session *session) {
+    size_t length = output_length;
+    const char *data = output;
+    output_length = 0;
+    if (output_overflowed) {
+        output_overflowed = false;
+        return false;
+    }
+    if (session->pending_length == 0) {
+        ssize_t sent = send_some(session->fd, data, length);
+        if (sent < 0)
+            return false;
+        data += sent;
+        length -= (size_t)sent;
+    }
+    if (length == 0)
+        return true;
+    if (session->pending_length + length > MAX_PENDING)
+        return false;
+    char *pending = realloc(session->pending, session->pending_length + length);
+    if (!pending)
+        return false;
+    memcpy(pending + session->pending_length, data, length);
+    session->pending = pending;
+    session->pending_length += (unsigned)length;
+    return true;
+}
+
+// Retries the pending buffer once the socket is writable again.
+static bool flush_pending(Session *session) {
+    if (session->pending_length == 0)
+        return true;
+    ssize_t sent = send_some(session->fd, session->pending, session->pending_length);
+    if (sent < 0)
+        return false;
+    session->pending_length -= (unsigned)sent;
+    if (session->pending_length == 0) {
+        free(session->pending);
+        session->pending = NULL;
+    } else {
+        memmove(session->pending, session->pending + sent, session->pending_length);
+    }
+    return true;
+}
+
+static bool resume_accepting(int epoll_fd) {
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;  // The listening socket.
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_socket, &event) != 0)
+        return false;
+    accept_paused = false;
+    return true;
+}
+
+static void close_session(int epoll_fd, Session *session) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, session->fd, NULL);
+    close(session->fd);
+    free(session->pending);
+    pool_free(&session_pool, session);
+    if (accept_paused)
+        resume_accepting(epoll_fd);
+}
+
+// Only asks for writability while replies are waiting, so idle sessions cost
+// nothing but their memory.
+static bool update_interest(int epoll_fd, Session *session) {
+    bool want_write = session->pending_length > 0;
+    if (want_write == session->writing)
+        return true;
+    struct epoll_event event;
+    event.events = EPOLLIN | (want_write ? EPOLLOUT : 0);
+    event.data.ptr = session;
+    session->writing = want_write;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, session->fd, &event) == 0;
+}
+
+// Takes every pending connection off the listening socket and closes it, using
+// the spare descriptor's slot. Returns false if that did not work.
+static bool drop_connections(void) {
+    if (spare_fd < 0)
+        return false;
+    close(spare_fd);
+    int fd;
+    while ((fd = accept4(listen_socket, NULL, NULL, SOCK_CLOEXEC)) >= 0 || errno == EINTR)
+        if (fd >= 0)
+            close(fd);
+    bool drained = errno == EAGAIN || errno == EWOULDBLOCK;
+    spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return drained;
+}
+
+// The listening socket is level-triggered: it stays readable until every
+// pending connection is accepted or dropped.
+static void accept_sessions(int epoll_fd) {
+    while (true) {
+        int fd = accept4(listen_socket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                if (!out_of_fds)
+                    fprintf(stderr, "accept: %s; refusing connections until sessions close.\n",
+                            strerror(errno));
+                out_of_fds = true;
+                // accept() fails this way even with nothing pending, so retrying
+                // would never reach EAGAIN.
+                if (!drop_connections() && epoll_ctl(epoll_fd, EPOLL_CTL_DEL, listen_socket, NULL) == 0)
+                    accept_paused = true;
+                return;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                perror("accept");
+            return;
+        }
+        out_of_fds = false;
+        Session *session = pool_alloc(&session_pool);
+        if (!session) {
+            close(fd);
+            continue;
+        }
+        session->fd = fd;
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = session;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            pool_free(&session_pool, session);
+            continue;
+        }
+        start_game(session);
+        if (!deliver_output(session) || !update_interest(epoll_fd, session))
+            close_session(epoll_fd, session);
+    }
+}
+
+// Reads whatever has arrived and runs every complete command line in it.
+// Returns false if the session should be closed.
+static bool read_commands(Session *session) {
+    char buffer[4096];
+    while (true) {
+        ssize_t n = recv(session->fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if (n <= 0)
+            return false;
+        for (ssize_t i = 0; i < n; i++) {
+            if (buffer[i] != '\n') {
+                if (session->input_length < MAX_LINE - 1)
+                    session->input[session->input_length++] = buffer[i];
+                continue;
+            }
+            session->input[session->input_length] = '\0';
+            session->input_length = 0;
+            if (session->closing)
+                continue;
+            handle_line(session, session->input);
+            // No single reply comes close to half the buffer.
+            if (output_length > OUTPUT_BUFFER / 2 && !deliver_output(session))
+                return false;
+        }
+        if (!deliver_output(session))
+            return false;
+    }
+}
+
+static int run_server(int listen_fd) {
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        perror("epoll_create1");
+        return 1;
+    }
+    struct epoll_event events[MAX_EVENTS];
+    listen_socket = listen_fd;
+    if (!resume_accepting(epoll_fd)) {
+        perror("epoll_ctl");
+        return 1;
+    }
+    spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    pool_init(&session_pool, sizeof(Session), SESSIONS_PER_SLAB);
+    while (true) {
+        int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            return 1;
+        }
+        for (int e = 0; e < ready; e++) {
+            Session *session = events[e].data.ptr;
+            if (!session) {
+                accept_sessions(epoll_fd);
+                continue;
+            }
+            bool ok = true;
+            if (events[e].events & EPOLLOUT)
+                ok = flush_pending(session);
+            if (ok && (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+                ok = read_commands(session);
+            if (ok && session->closing && session->pending_length == 0)
+                ok = false;
+            if (ok)
+                ok = update_interest(epoll_fd, session);
+            if (!ok)
+                close_session(epoll_fd, session);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// main()
+// -----------------------------------------------------------------------------
+
+// Every session holds a descriptor, and the usual soft limit of 1024 is far
+// below the number of idle sessions one process can keep. Raises the soft
+// limit as far as the hard limit allows and returns it.
+static long raise_fd_limit(void) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return -1;
+    if (limit.rlim_cur < limit.rlim_max) {
+        rlim_t wanted = limit.rlim_max;
+        limit.rlim_cur = wanted;
+        // An unlimited hard limit is still capped by the kernel's nr_open.
+        if (setrlimit(RLIMIT_NOFILE, &limit) != 0 && wanted == RLIM_INFINITY) {
+            limit.rlim_cur = 1 << 20;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return limit.rlim_cur == RLIM_INFINITY ? -1 : (long)limit.rlim_cur;
+}
+
+static int listen_unix(const char *path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(path);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        perror(path);
+        return -1;
+    }
+    return fd;
+}
+
+// Loopback only: the protocol has no authentication.
+static int listen_tcp(int port) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int yes = 1;
+    if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) != 0 ||
+        bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        perror("tcp");
+        return -1;
+    }
+    return fd;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [--socket PATH | --tcp PORT] [--seed N]\n", prog);
+    printf("  --socket PATH   Unix domain socket to listen on (default: battleships.sock).\n");
+    printf("  --tcp PORT      Listen on 127.0.0.1:PORT instead.\n");
+    printf("  --seed N        Seed for the fleets and the computer (default: current time).\n");
+}
+
+int main(int argc, char *argv[]) {
+    engine_init();
+    const char *socket_path = "battleships.sock";
+    int tcp_port = 0;
+    server_seed = (uint64_t)time(NULL);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+            socket_path = argv[++i];
+        else if (strcmp(argv[i], "--tcp") == 0 && i + 1 < argc)
+            tcp_port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            server_seed = strtoull(argv[++i], NULL, 10);
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    game_init(&current, PLAYER_NAME, NULL, "Computer", &NIGHTMARE_STRATEGY, server_seed);
+    long fd_limit = raise_fd_limit();
+    int listen_fd = tcp_port > 0 ? listen_tcp(tcp_port) : listen_unix(socket_path);
+    if (listen_fd < 0)
+        return 1;
+    if (tcp_port > 0)
+        printf("Listening on 127.0.0.1:%d", tcp_port);
+    else
+        printf("Listening on %s", socket_path);
+    printf(" (%zu bytes per idle session", sizeof(Session));
+    if (fd_limit > 0)
+        printf(", %ld descriptors", fd_limit);
+    printf(").\n");
+    fflush(stdout);
+    return run_server(listen_fd);
+}
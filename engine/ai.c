@@ -0,0 +1,454 @@
+#include "battleships.h"
+
+bool standard_parity = true;
+
+static void standard_reset(void *state);
+static void clear_target_candidates(StandardState *state);
+static int smallest_afloat(const StandardState *state);
+static void hunt_set_parity(StandardState *state, int parity);
+
+// -----------------------------------------------------------------------------
+// Standard AI Functionality (Easy/Medium)
+// -----------------------------------------------------------------------------
+
+static void *standard_init(void) {
+    StandardState *state = malloc(sizeof(*state));
+    if (state)
+        standard_reset(state);
+    return state;
+}
+
+static void standard_reset(void *opaque) {
+    StandardState *state = opaque;
+    state->mode = HUNT_MODE;
+    state->last_hit_x = -1;
+    state->last_hit_y = -1;
+    clear_target_candidates(state);
+    memcpy(state->ships_afloat, FLEET_LENGTH_COUNT, sizeof(state->ships_afloat));
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        state->hunt_cells[cell] = (unsigned short)cell;
+        state->hunt_pos[cell] = (unsigned short)cell;
+    }
+    state->num_hunt = BOARD_CELLS;
+    hunt_set_parity(state, smallest_afloat(state));
+}
+
+// Length of the shortest ship still afloat, or 1 when parity hunting is off.
+static int smallest_afloat(const StandardState *state) {
+    if (!standard_parity)
+        return 1;
+    for (int k = NUM_FLEET_LENGTHS - 1; k >= 0; k--)
+        if (state->ships_afloat[k] > 0)
+            return FLEET_LENGTHS[k];
+    return 1;
+}
+
+static void hunt_swap(StandardState *state, int a, int b) {
+    unsigned short cell_a = state->hunt_cells[a], cell_b = state->hunt_cells[b];
+    state->hunt_cells[a] = cell_b;
+    state->hunt_cells[b] = cell_a;
+    state->hunt_pos[cell_b] = (unsigned short)a;
+    state->hunt_pos[cell_a] = (unsigned short)b;
+}
+
+// Regroups the untried cells so those with (x + y) % parity == 0 come first.
+static void hunt_set_parity(StandardState *state, int parity) {
+    int front = 0;
+    for (int i = 0; i < state->num_hunt; i++) {
+        int cell = state->hunt_cells[i];
+        if ((cell / BOARD_SIZE + cell % BOARD_SIZE) % parity == 0)
+            hunt_swap(state, i, front++);
+    }
+    state->hunt_parity = parity;
+    state->num_hunt_parity = front;
+}
+
+// Takes a shot cell off the hunt list in constant time.
+static void hunt_remove(StandardState *state, int cell) {
+    int i = state->hunt_pos[cell];
+    if (i >= state->num_hunt)
+        return;
+    if (i < state->num_hunt_parity) {
+        hunt_swap(state, i, --state->num_hunt_parity);
+        i = state->num_hunt_parity;
+    }
+    hunt_swap(state, i, --state->num_hunt);
+}
+
+// Picks a random untried cell, from the parity class while it has any left.
+static int hunt_pick(const StandardState *state, Rng *rng) {
+    int pool = state->num_hunt_parity > 0 ? state->num_hunt_parity : state->num_hunt;
+    return state->hunt_cells[rng_below(rng, pool)];
+}
+
+static void clear_target_candidates(StandardState *state) {
+    state->num_candidates = 0;
+    memset(&state->queued_candidates, 0, sizeof(state->queued_candidates));
+}
+
+// Takes the most recently pushed candidate, so the AI keeps following the
+// latest hit.
+static int pop_target_candidate(StandardState *state) {
+    return state->target_candidates[--state->num_candidates];
+}
+
+// Pushes the unattacked neighbours of a hit. Each cell is pushed at most once per
+// target run, so the stack never holds more than BOARD_CELLS entries.
+void add_target_candidates(StandardState *state, int x, int y, const Board *guess) {
+    int directions[4][2] = { {-1,0}, {1,0}, {0,-1}, {0,1} };
+    for (int d = 0; d < 4; d++) {
+        int nx = x + directions[d][0];
+        int ny = y + directions[d][1];
+        if (nx >= 0 && nx < BOARD_SIZE && ny >= 0 && ny < BOARD_SIZE) {
+            int cell = cell_index(nx, ny);
+            if (!is_attacked(guess, nx, ny) && !bb_test(&state->queued_candidates, cell)) {
+                bb_set(&state->queued_candidates, cell);
+                state->target_candidates[state->num_candidates++] = (unsigned short)cell;
+            }
+        }
+    }
+}
+
+// Works through the pushed neighbours of the current target run, and hunts once
+// they run out.
+static void standard_choose_shot(void *opaque, const Board *guess, Rng *rng, int *x, int *y) {
+    StandardState *state = opaque;
+    (void)guess;
+    if (state->mode == TARGET_MODE && state->num_candidates == 0)
+        state->mode = HUNT_MODE;
+    int cell = state->mode == TARGET_MODE ? pop_target_candidate(state) : hunt_pick(state, rng);
+    *x = cell / BOARD_SIZE;
+    *y = cell % BOARD_SIZE;
+}
+
+// A hit starts (or extends) a target run; sinking the ship under the latest hit
+// ends it.
+static void standard_observe_result(void *opaque, const Board *guess, int x, int y,
+                                    AttackResult result, int sunk_size) {
+    StandardState *state = opaque;
+    hunt_remove(state, cell_index(x, y));
+    if (result != ATTACK_MISS) {
+        if (state->mode == HUNT_MODE) {
+            state->mode = TARGET_MODE;
+            clear_target_candidates(state);
+        }
+        state->last_hit_x = x;
+        state->last_hit_y = y;
+        add_target_candidates(state, x, y, guess);
+    }
+    if (result == ATTACK_SUNK) {
+        state->ships_afloat[fleet_slot(sunk_size)]--;
+        int parity = smallest_afloat(state);
+        if (parity != state->hunt_parity)
+            hunt_set_parity(state, parity);
+    }
+    if (state->mode == TARGET_MODE &&
+        bb_test(&guess->sunk, cell_index(state->last_hit_x, state->last_hit_y))) {
+        state->mode = HUNT_MODE;
+        clear_target_candidates(state);
+        state->last_hit_x = -1;
+        state->last_hit_y = -1;
+    }
+}
+
+const Strategy STANDARD_STRATEGY = {
+    "standard", "Standard",
+    standard_init, standard_reset, standard_choose_shot, standard_observe_result, free, false
+};
+
+// -----------------------------------------------------------------------------
+// Opening Book
+// -----------------------------------------------------------------------------
+
+bool use_opening_book = true;
+
+static const OpeningBook *opening_book;             // Book for the configured game, or NULL.
+static Bitboard opening_misses[OPENING_BOOK_DEPTH]; // Misses before each book shot.
+
+// Picks the book matching the board and fleet, if any.
+void init_opening_book(void) {
+    opening_book = NULL;
+    if (!use_opening_book)
+        return;
+    for (int b = 0; b < NUM_OPENING_BOOKS && !opening_book; b++) {
+        const OpeningBook *book = &OPENING_BOOKS[b];
+        if (book->board_size != BOARD_SIZE || book->num_ships != NUM_SHIPS)
+            continue;
+        bool same_fleet = true;
+        for (int i = 0; i < NUM_SHIPS; i++)
+            same_fleet = same_fleet && book->ship_sizes[i] == SHIP_SIZES[i];
+        if (same_fleet)
+            opening_book = book;
+    }
+    if (!opening_book)
+        return;
+    Bitboard misses = { { 0 } };
+    for (int n = 0; n < opening_book->depth; n++) {
+        opening_misses[n] = misses;
+        bb_set(&misses, opening_book->cells[n]);
+    }
+}
+
+// The book's next shot, as long as every shot so far has missed and followed
+// the book.
+static bool opening_book_shot(const Board *ai_guess, int *x, int *y) {
+    if (!opening_book || !bb_is_empty(ai_guess->hits))
+        return false;
+    int ply = bb_count(ai_guess->misses);
+    if (ply >= opening_book->depth || !bb_equal(ai_guess->misses, opening_misses[ply]))
+        return false;
+    *x = opening_book->cells[ply] / BOARD_SIZE;
+    *y = opening_book->cells[ply] % BOARD_SIZE;
+    return true;
+}
+
+// Plays the all-miss line against an empty board with the book switched off
+// and writes it as an OPENING_BOOKS entry for the configured game.
+int write_opening_book(FILE *out, int depth) {
+    int ship_cells = 0;
+    for (int i = 0; i < NUM_SHIPS; i++)
+        ship_cells += SHIP_SIZES[i];
+    if (depth > OPENING_BOOK_DEPTH)
+        depth = OPENING_BOOK_DEPTH;
+    if (depth > BOARD_CELLS - ship_cells)
+        depth = BOARD_CELLS - ship_cells;
+    if (depth < 1 || NUM_SHIPS > OPENING_BOOK_SHIPS) {
+        fprintf(stderr, "No opening book for this game.\n");
+        return 1;
+    }
+    const OpeningBook *saved = opening_book;
+    opening_book = NULL;
+    void *state = start_strategy(&NIGHTMARE_STRATEGY);
+    Board guess;
+    initialize_board(&guess);
+    int cells[OPENING_BOOK_DEPTH];
+    for (int n = 0; n < depth; n++) {
+        int x, y;
+        nightmare_choose_shot(state, &guess, NULL, &x, &y);
+        cells[n] = cell_index(x, y);
+        bb_set(&guess.misses, cells[n]);
+        nightmare_observe_result(state, &guess, x, y, ATTACK_MISS, 0);
+    }
+    NIGHTMARE_STRATEGY.destroy(state);
+    opening_book = saved;
+
+    fprintf(out, "    // %dx%d:", BOARD_SIZE, BOARD_SIZE);
+    for (int i = 0; i < NUM_SHIPS; i++)
+        fprintf(out, "%s%d", i ? "," : " ", SHIP_SIZES[i]);
+    fprintf(out, "\n    { %d, %d, {", BOARD_SIZE, NUM_SHIPS);
+    for (int i = 0; i < NUM_SHIPS; i++)
+        fprintf(out, "%s %d", i ? "," : "", SHIP_SIZES[i]);
+    fprintf(out, " }, %d,\n      {", depth);
+    for (int n = 0; n < depth; n++)
+        fprintf(out, "%s %d", n ? "," : "", cells[n]);
+    fprintf(out, " } },\n");
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Nightmare Mode AI (Hard)
+// -----------------------------------------------------------------------------
+
+// Starts from every placement being possible.
+void density_init(DensityMap *map) {
+    memset(&map->blocked, 0, sizeof(map->blocked));
+    memset(map->dropped, 0, sizeof(map->dropped));
+    for (int k = 0; k < NUM_FLEET_LENGTHS; k++)
+        for (int cell = 0; cell < BOARD_CELLS; cell++)
+            map->coverage[k][cell] = NUM_COVERING[k][cell];
+}
+
+// Drops every placement touching a cell of `blocked` that was not applied before.
+// Slots with a zero weight no longer contribute and are left stale.
+void density_block(DensityMap *map, Bitboard blocked, const int *weights) {
+    Bitboard fresh = bb_andnot(blocked, map->blocked);
+    map->blocked = bb_or(map->blocked, fresh);
+    while (!bb_is_empty(fresh)) {
+        int cell = bb_pop_lowest(&fresh);
+        for (int k = 0; k < NUM_FLEET_LENGTHS; k++) {
+            if (weights[k] == 0)
+                continue;
+            for (int c = 0; c < NUM_COVERING[k][cell]; c++) {
+                int index = COVERING[k][cell][c];
+                uint64_t bit = (uint64_t)1 << (index & 63);
+                if (map->dropped[k][index >> 6] & bit)
+                    continue;
+                map->dropped[k][index >> 6] |= bit;
+                const Placement *p = &PLACEMENTS[k][index];
+                for (int n = 0, covered = p->cell; n < p->size; n++, covered += p->step)
+                    map->coverage[k][covered]--;
+            }
+        }
+    }
+}
+
+// Density for the nightmare AI, counting only the ships still afloat. With a
+// vector kernel available, recomputing the whole grid is cheaper than
+// maintaining the incremental map; without one, the incremental map is brought
+// up to date with any new misses or sunk cells and each slot's coverage is
+// weighted by how many ships of that length are left.
+static void nightmare_density(NightmareState *state, const Board *ai_guess, int prob[MAX_BOARD_SIZE][MAX_BOARD_SIZE]) {
+    Bitboard blocked = bb_or(ai_guess->misses, ai_guess->sunk);
+    const int *weights = state->ships_afloat;
+    if (density_kernel != density_kernel_scalar) {
+        DensityGrid grid;
+        density_kernel(blocked, weights, grid);
+        for (int i = 0; i < BOARD_SIZE; i++)
+            for (int j = 0; j < BOARD_SIZE; j++)
+                prob[i][j] = grid[i][j];
+        return;
+    }
+    density_block(&state->density, blocked, weights);
+    memset(prob, 0, sizeof(int) * MAX_BOARD_CELLS);
+    for (int k = 0; k < NUM_FLEET_LENGTHS; k++) {
+        const unsigned char *coverage = state->density.coverage[k];
+        if (weights[k] == 0)
+            continue;
+        for (int i = 0; i < BOARD_SIZE; i++)
+            for (int j = 0; j < BOARD_SIZE; j++)
+                prob[i][j] += weights[k] * coverage[cell_index(i, j)];
+    }
+}
+
+void *nightmare_init(void) {
+    NightmareState *state = malloc(sizeof(*state));
+    if (state)
+        nightmare_reset(state);
+    return state;
+}
+
+void nightmare_reset(void *opaque) {
+    NightmareState *state = opaque;
+    // Only the scalar kernel keeps the incremental map; vector kernels recompute
+    // the whole grid each turn.
+    if (density_kernel == density_kernel_scalar)
+        density_init(&state->density);
+    memcpy(state->ships_afloat, FLEET_LENGTH_COUNT, sizeof(state->ships_afloat));
+    memset(&state->open_hits, 0, sizeof(state->open_hits));
+}
+
+// Tracks open hits and, on a sink, removes that ship's length from the ones the
+// density map still counts.
+void nightmare_observe_result(void *opaque, const Board *ai_guess, int x, int y,
+                              AttackResult result, int sunk_size) {
+    NightmareState *state = opaque;
+    if (result != ATTACK_MISS)
+        bb_set(&state->open_hits, cell_index(x, y));
+    if (result == ATTACK_SUNK) {
+        int slot = fleet_slot(sunk_size);
+        if (slot >= 0 && state->ships_afloat[slot] > 0)
+            state->ships_afloat[slot]--;
+        state->open_hits = bb_andnot(state->open_hits, ai_guess->sunk);
+    }
+}
+
+// Target mode: picks the next shot around the open hits, or returns false when
+// there are none. Once two hits touch along a row or column the ship's axis is
+// known and only the cells extending that line are considered; otherwise every
+// unknown neighbour of the cluster is. Candidates are ranked by how many
+// still-possible placements of afloat ships pass through both the candidate and
+// an open hit.
+static bool nightmare_target(const NightmareState *state, const Board *ai_guess, int *target_x, int *target_y) {
+    Bitboard hits = state->open_hits;
+    if (bb_is_empty(hits))
+        return false;
+    Bitboard unknown = bb_andnot(BOARD_MASK, bb_or(ai_guess->hits, ai_guess->misses));
+    Bitboard blocked = bb_or(ai_guess->misses, ai_guess->sunk);
+
+    Bitboard row_line = bb_and(hits, bb_row_neighbours(hits));
+    Bitboard column_line = bb_and(hits, bb_column_neighbours(hits));
+    Bitboard candidates = bb_and(bb_or(bb_row_neighbours(row_line), bb_column_neighbours(column_line)), unknown);
+    if (bb_is_empty(candidates))
+        candidates = bb_and(bb_neighbours(hits), unknown);
+    if (bb_is_empty(candidates))
+        return false;
+
+    int best_cell = -1, best_score = -1;
+    while (!bb_is_empty(candidates)) {
+        int cell = bb_pop_lowest(&candidates);
+        int score = 0;
+        for (int k = 0; k < NUM_FLEET_LENGTHS; k++) {
+            if (state->ships_afloat[k] == 0)
+                continue;
+            for (int c = 0; c < NUM_COVERING[k][cell]; c++) {
+                const Placement *p = &PLACEMENTS[k][COVERING[k][cell][c]];
+                if (!bb_intersects(p->cells, blocked) && bb_intersects(p->cells, hits))
+                    score += state->ships_afloat[k];
+            }
+        }
+        if (score > best_score) {
+            best_score = score;
+            best_cell = cell;
+        }
+    }
+    *target_x = best_cell / BOARD_SIZE;
+    *target_y = best_cell % BOARD_SIZE;
+    return true;
+}
+
+// This function uses a separate AI guess board (ai_guess) to compute a probability
+// density map and choose the best cell. Open hits are finished off first, and
+// the opening shots come from the book.
+void nightmare_choose_shot(void *opaque, const Board *ai_guess, Rng *rng, int *x, int *y) {
+    NightmareState *state = opaque;
+    int i, j;
+    (void)rng;
+    // Finish off ships that have been hit before hunting for new ones.
+    if (nightmare_target(state, ai_guess, x, y))
+        return;
+    if (opening_book_shot(ai_guess, x, y))
+        return;
+
+    // Compute a probability density map for each untried cell.
+    Bitboard unknown = bb_andnot(BOARD_MASK, bb_or(ai_guess->hits, ai_guess->misses));
+    int prob[MAX_BOARD_SIZE][MAX_BOARD_SIZE];
+    nightmare_density(state, ai_guess, prob);
+    // Choose the cell with the highest probability.
+    int maxProb = -1, best_i = -1, best_j = -1;
+    for (i = 0; i < BOARD_SIZE; i++) {
+        for (j = 0; j < BOARD_SIZE; j++) {
+            if (bb_test(&unknown, cell_index(i, j)) && prob[i][j] > maxProb) {
+                maxProb = prob[i][j];
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+    *x = best_i;
+    *y = best_j;
+}
+
+const Strategy NIGHTMARE_STRATEGY = {
+    "nightmare", "Nightmare",
+    nightmare_init, nightmare_reset, nightmare_choose_shot, nightmare_observe_result, free, true
+};
+
+// -----------------------------------------------------------------------------
+// Strategy Registry
+// -----------------------------------------------------------------------------
+
+// Every computer opponent. New strategies only need an entry here to become
+// available to --p1/--p2; the first one is the default.
+const Strategy *const STRATEGIES[] = {
+    &NIGHTMARE_STRATEGY,
+    &EXACT_STRATEGY,
+    &STANDARD_STRATEGY,
+};
+const int NUM_STRATEGIES = sizeof(STRATEGIES) / sizeof(STRATEGIES[0]);
+
+const Strategy *find_strategy(const char *name) {
+    for (int i = 0; i < NUM_STRATEGIES; i++)
+        if (strcmp(STRATEGIES[i]->name, name) == 0)
+            return STRATEGIES[i];
+    return NULL;
+}
+
+// Creates a strategy's state; running out of memory here is fatal.
+void *start_strategy(const Strategy *strategy) {
+    void *state = strategy->init();
+    if (!state) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    return state;
+}
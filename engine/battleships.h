@@ -0,0 +1,671 @@
+// Shared battleships engine: boards, rules, fleet placement, the computer
+// strategies, batch simulation and game logs. Every front-end includes this
+// header and links the engine library built from engine/*.c.
+//
+// The board size and fleet are fixed at compile time, so every loop over the
+// board has a constant trip count and bitboards have a fixed number of words.
+// Define BOARD_SIZE and FLEET (a comma-separated list of ship lengths) to build
+// an engine specialised for another game, or RUNTIME_BOARD for the fallback
+// engine whose size and fleet are set at startup with engine_configure(). The
+// front-end must be compiled with the same definitions.
+#ifndef BATTLESHIPS_H
+#define BATTLESHIPS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86_KERNELS 1
+#endif
+
+// -----------------------------------------------------------------------------
+// Configuration & Global Constants
+// -----------------------------------------------------------------------------
+
+#ifdef RUNTIME_BOARD
+// Fallback engine: arrays are sized for the largest supported board and fleet,
+// and BOARD_SIZE, SHIP_SIZES and NUM_SHIPS are variables (10x10 with the
+// standard fleet until engine_configure() changes them).
+#define MAX_BOARD_SIZE 16
+#define MAX_SHIPS 16
+extern int runtime_board_size;
+extern int SHIP_SIZES[MAX_SHIPS];
+extern int NUM_SHIPS;
+#define BOARD_SIZE runtime_board_size
+#else
+#ifndef BOARD_SIZE
+#define BOARD_SIZE 10
+#endif
+#define MAX_BOARD_SIZE BOARD_SIZE
+
+// Ship sizes: by default one ship of size 5, one of size 3, two of size 2, one of size 1.
+#ifndef FLEET
+#define FLEET 5, 3, 2, 2, 1
+#endif
+static const int SHIP_SIZES[] = { FLEET };
+static const int NUM_SHIPS = sizeof(SHIP_SIZES) / sizeof(SHIP_SIZES[0]);
+#define MAX_SHIPS ((int)(sizeof(SHIP_SIZES) / sizeof(SHIP_SIZES[0])))
+#endif
+
+// Columns are labelled with letters, and a cell index fits in an unsigned char.
+#if MAX_BOARD_SIZE < 1 || MAX_BOARD_SIZE > 16
+#error "BOARD_SIZE must be between 1 and 16"
+#endif
+static const char ALPHABET[] = "ABCDEFGHIJKLMNOP";
+
+// The standard AI hunts only on cells a ship of the smallest remaining length must
+// touch (every k-th diagonal); --no-parity makes it hunt on every untried cell.
+extern bool standard_parity;
+
+// --colour draws hits, misses, sunk ships and intact ships in ANSI colours.
+extern bool ansi_colour;
+
+// -----------------------------------------------------------------------------
+// Bitboards
+// -----------------------------------------------------------------------------
+
+// Each board layer is a bit mask over the grid, bit (x * BOARD_SIZE + y) for
+// row x and column y. A 10x10 board fits in two 64-bit words (128 bits).
+// Arrays indexed by cell are sized with MAX_BOARD_CELLS.
+#define BOARD_CELLS (BOARD_SIZE * BOARD_SIZE)
+#define MAX_BOARD_CELLS (MAX_BOARD_SIZE * MAX_BOARD_SIZE)
+#define MASK_WORDS ((MAX_BOARD_CELLS + 63) / 64)
+
+typedef struct {
+    uint64_t w[MASK_WORDS];
+} Bitboard;
+
+static inline int cell_index(int x, int y) {
+    return x * BOARD_SIZE + y;
+}
+
+static inline bool bb_test(const Bitboard *b, int cell) {
+    return (b->w[cell >> 6] >> (cell & 63)) & 1;
+}
+
+static inline void bb_set(Bitboard *b, int cell) {
+    b->w[cell >> 6] |= (uint64_t)1 << (cell & 63);
+}
+
+static inline Bitboard bb_or(Bitboard a, Bitboard b) {
+    for (int i = 0; i < MASK_WORDS; i++)
+        a.w[i] |= b.w[i];
+    return a;
+}
+
+static inline Bitboard bb_and(Bitboard a, Bitboard b) {
+    for (int i = 0; i < MASK_WORDS; i++)
+        a.w[i] &= b.w[i];
+    return a;
+}
+
+static inline Bitboard bb_andnot(Bitboard a, Bitboard b) {
+    for (int i = 0; i < MASK_WORDS; i++)
+        a.w[i] &= ~b.w[i];
+    return a;
+}
+
+static inline bool bb_is_empty(Bitboard b) {
+    uint64_t any = 0;
+    for (int i = 0; i < MASK_WORDS; i++)
+        any |= b.w[i];
+    return any == 0;
+}
+
+static inline bool bb_intersects(Bitboard a, Bitboard b) {
+    return !bb_is_empty(bb_and(a, b));
+}
+
+static inline bool bb_equal(Bitboard a, Bitboard b) {
+    uint64_t diff = 0;
+    for (int i = 0; i < MASK_WORDS; i++)
+        diff |= a.w[i] ^ b.w[i];
+    return diff == 0;
+}
+
+// Shifts every bit towards higher (n > 0) or lower (n < 0) cell indices.
+static inline Bitboard bb_shift(Bitboard b, int n) {
+    Bitboard r = { { 0 } };
+    int words = (n < 0 ? -n : n) >> 6;
+    int bits = (n < 0 ? -n : n) & 63;
+    for (int i = 0; i < MASK_WORDS; i++) {
+        int src = n >= 0 ? i - words : i + words;
+        if (src < 0 || src >= MASK_WORDS)
+            continue;
+        if (n >= 0) {
+            r.w[i] |= b.w[src] << bits;
+            if (bits && src - 1 >= 0)
+                r.w[i] |= b.w[src - 1] >> (64 - bits);
+        } else {
+            r.w[i] |= b.w[src] >> bits;
+            if (bits && src + 1 < MASK_WORDS)
+                r.w[i] |= b.w[src + 1] << (64 - bits);
+        }
+    }
+    return r;
+}
+
+// Masks filled in by engine_init(): every cell, and the first/last column.
+extern Bitboard BOARD_MASK, FIRST_COLUMN, LAST_COLUMN;
+
+// Number of cells set.
+static inline int bb_count(Bitboard b) {
+    int n = 0;
+    for (int i = 0; i < MASK_WORDS; i++)
+        n += __builtin_popcountll(b.w[i]);
+    return n;
+}
+
+// Index of the lowest set bit, which is then cleared. b must not be empty.
+static inline int bb_pop_lowest(Bitboard *b) {
+    for (int i = 0; ; i++) {
+        if (b->w[i]) {
+            int bit = __builtin_ctzll(b->w[i]);
+            b->w[i] &= b->w[i] - 1;
+            return i * 64 + bit;
+        }
+    }
+}
+
+// Cells directly left/right of any cell of b, within the same row.
+static inline Bitboard bb_row_neighbours(Bitboard b) {
+    return bb_or(bb_shift(bb_andnot(b, LAST_COLUMN), 1), bb_shift(bb_andnot(b, FIRST_COLUMN), -1));
+}
+
+// Cells directly above/below any cell of b.
+static inline Bitboard bb_column_neighbours(Bitboard b) {
+    return bb_and(bb_or(bb_shift(b, BOARD_SIZE), bb_shift(b, -BOARD_SIZE)), BOARD_MASK);
+}
+
+// Cells orthogonally adjacent to any cell of b.
+static inline Bitboard bb_neighbours(Bitboard b) {
+    return bb_or(bb_row_neighbours(b), bb_column_neighbours(b));
+}
+
+// Bits of row x (bit y set for column y).
+static inline unsigned row_bits(Bitboard b, int x) {
+    int cell = cell_index(x, 0);
+    int word = cell >> 6, bit = cell & 63;
+    uint64_t bits = b.w[word] >> bit;
+    if (bit + BOARD_SIZE > 64 && word + 1 < MASK_WORDS)
+        bits |= b.w[word + 1] << (64 - bit);
+    return (unsigned)(bits & ((1u << BOARD_SIZE) - 1));
+}
+
+// -----------------------------------------------------------------------------
+// Board Representation
+// -----------------------------------------------------------------------------
+
+// A placed ship. `remaining` counts the hits it can still take before sinking.
+typedef struct {
+    Bitboard cells;
+    unsigned char size;
+    unsigned char remaining;
+    unsigned char x, y;
+    bool horizontal;
+} Ship;
+
+// A board is four layers plus the registry of ships placed on it. The classic
+// symbols are derived from the layers:
+// '0' sunk, '#' hit, 'x' miss, '&' intact ship, '.' water.
+// Guess boards (what a player knows about the opponent) use the same struct
+// with an empty ships layer and no registered ships.
+typedef struct {
+    Bitboard ships;   // Every ship cell, intact or hit.
+    Bitboard hits;    // Ship cells that have been hit.
+    Bitboard misses;  // Attacked water.
+    Bitboard sunk;    // Cells of destroyed ships.
+    Ship fleet[MAX_SHIPS];
+    int num_ships;
+    int intact_cells; // Ship cells not yet hit; the board is defeated at 0.
+    unsigned char ship_at[MAX_BOARD_CELLS]; // Fleet index + 1 for each ship cell, 0 for water.
+} Board;
+
+typedef enum {
+    ATTACK_MISS,  // Water, or a cell that was already attacked.
+    ATTACK_HIT,
+    ATTACK_SUNK   // Hit that destroyed the last intact part of a ship.
+} AttackResult;
+
+static inline char board_symbol(const Board *board, int x, int y) {
+    int cell = cell_index(x, y);
+    if (bb_test(&board->sunk, cell)) return '0';
+    if (bb_test(&board->hits, cell)) return '#';
+    if (bb_test(&board->misses, cell)) return 'x';
+    if (bb_test(&board->ships, cell)) return '&';
+    return '.';
+}
+
+static inline bool is_attacked(const Board *board, int x, int y) {
+    int cell = cell_index(x, y);
+    return bb_test(&board->hits, cell) || bb_test(&board->misses, cell);
+}
+
+// -----------------------------------------------------------------------------
+// Random Number Generation
+// -----------------------------------------------------------------------------
+
+// Small, fast PRNG (SplitMix64). Every game loop and every worker thread owns its
+// own generator, so nothing shares hidden global state the way rand() does.
+typedef struct {
+    uint64_t state;
+} Rng;
+
+static inline void rng_seed(Rng *rng, uint64_t seed) {
+    rng->state = seed;
+}
+
+static inline uint64_t rng_next(Rng *rng) {
+    uint64_t z = (rng->state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform integer in [0, bound) (multiply-shift reduction, bias is negligible for small bounds).
+static inline int rng_below(Rng *rng, int bound) {
+    return (int)(((rng_next(rng) >> 32) * (uint64_t)bound) >> 32);
+}
+
+// -----------------------------------------------------------------------------
+// Placement Tables
+// -----------------------------------------------------------------------------
+
+// Every horizontal and vertical position of a ship of a given length, built once
+// by engine_init(). Length-1 ships appear twice (once per orientation), which
+// matches how the density map has always weighted them.
+#define MAX_PLACEMENTS (2 * MAX_BOARD_CELLS)
+#define MAX_COVERING (2 * MAX_BOARD_SIZE)
+
+typedef struct {
+    Bitboard cells;
+    unsigned char cell;   // First (top/left) cell.
+    unsigned char step;   // 1 for horizontal, BOARD_SIZE for vertical.
+    unsigned char size;
+} Placement;
+
+// The fleet grouped by length: FLEET_LENGTHS[k] ships of that length appear
+// FLEET_LENGTH_COUNT[k] times. Placement tables are indexed by this slot k.
+extern int FLEET_LENGTHS[MAX_SHIPS];
+extern int FLEET_LENGTH_COUNT[MAX_SHIPS];
+extern int NUM_FLEET_LENGTHS;
+
+extern Placement PLACEMENTS[MAX_SHIPS][MAX_PLACEMENTS];
+extern int NUM_PLACEMENTS[MAX_SHIPS];
+
+// For each slot and cell, the placements that cover the cell.
+extern unsigned short COVERING[MAX_SHIPS][MAX_BOARD_CELLS][MAX_COVERING];
+extern unsigned char NUM_COVERING[MAX_SHIPS][MAX_BOARD_CELLS];
+
+// Slot of the fleet length `size`, or -1 if no ship has that length.
+int fleet_slot(int size);
+
+// -----------------------------------------------------------------------------
+// Density Kernels
+// -----------------------------------------------------------------------------
+
+// Full-board probability density: for every cell, the number of placements of
+// each fleet length that avoid all blocked cells and cover the cell, weighted by
+// weights[slot]. Rows are padded to DENSITY_STRIDE bytes so a row is one SSE
+// register.
+#define DENSITY_STRIDE 16
+
+typedef unsigned char DensityGrid[MAX_BOARD_SIZE][DENSITY_STRIDE];
+typedef void (*DensityKernel)(Bitboard blocked, const int *weights, DensityGrid out);
+
+// Reference implementation, always available.
+void density_kernel_scalar(Bitboard blocked, const int *weights, DensityGrid out);
+
+// Selected by engine_init() from what the CPU supports.
+extern DensityKernel density_kernel;
+extern const char *density_kernel_name;
+
+void init_density_kernel(void);
+
+// -----------------------------------------------------------------------------
+// AI Definitions
+// -----------------------------------------------------------------------------
+
+typedef enum {
+    HUNT_MODE,
+    TARGET_MODE
+} AImode;
+
+// Incremental probability density for the nightmare AI. A placement is dropped
+// the first time a miss or sunk cell lands on it, and only the cells it covered
+// lose a count, so each turn costs a small delta instead of a full rescan.
+typedef struct {
+    Bitboard blocked;  // Misses and sunk cells already applied.
+    uint64_t dropped[MAX_SHIPS][(MAX_PLACEMENTS + 63) / 64];
+    unsigned char coverage[MAX_SHIPS][MAX_BOARD_CELLS]; // Live placements per slot covering each cell.
+} DensityMap;
+
+// A computer opponent. Each strategy keeps its own state behind an opaque pointer
+// and only sees its own guess board: the game loop fires the chosen shot, records
+// it on the guess board and then reports the outcome back.
+typedef struct {
+    const char *name;   // Used to pick the strategy with --p1/--p2.
+    const char *label;  // Shown in turn headers and shot messages.
+    void *(*init)(void);
+    void (*reset)(void *state);  // Back to the start of a game, without reallocating.
+    void (*choose_shot)(void *state, const Board *guess, Rng *rng, int *x, int *y);
+    // sunk_size is the length of the ship that went down, or 0 if none did.
+    void (*observe_result)(void *state, const Board *guess, int x, int y, AttackResult result, int sunk_size);
+    void (*destroy)(void *state);
+    // The state only depends on which cells were hit, missed and sunk, not on
+    // the order of the shots, so game_unpack() can rebuild it.
+    bool packable;
+} Strategy;
+
+// The engine never prints game events itself; it reports them to an observer.
+// TERMINAL_OBSERVER prints them for the interactive games. Passing NULL instead
+// of an observer is the null observer: nothing is reported, and since
+// computer_turn() is inline the reporting compiles away in headless games.
+// `shooter` and `winner` are display names such as "You" or
+// "Computer (Nightmare)"; any callback may be NULL.
+typedef struct {
+    void *context;
+    void (*shot)(void *context, const char *shooter, int x, int y);
+    void (*hit)(void *context, const char *shooter, int x, int y);
+    void (*miss)(void *context, const char *shooter, int x, int y);
+    void (*sink)(void *context, const char *shooter, int x, int y, int size);
+    void (*victory)(void *context, const char *winner);
+} GameObserver;
+
+// Standard AI: random hunting, then works through the neighbours of each hit.
+typedef struct {
+    AImode mode;
+    int last_hit_x;
+    int last_hit_y;
+    // Target mode: stack of cells to try, sized so it can never fill up, and
+    // the cells pushed since the hit that started the current target run.
+    unsigned short target_candidates[MAX_BOARD_CELLS];
+    int num_candidates;
+    Bitboard queued_candidates;
+    int ships_afloat[MAX_SHIPS]; // Ships not yet sunk, per fleet length slot.
+    // Hunt list: untried cells, those in the parity class first. Shot cells are
+    // swapped past num_hunt, so hunt_pos stays valid for every cell.
+    unsigned short hunt_cells[MAX_BOARD_CELLS];
+    unsigned short hunt_pos[MAX_BOARD_CELLS];
+    int num_hunt;
+    int num_hunt_parity;
+    int hunt_parity;
+} StandardState;
+
+// Nightmare AI, also used by the exact AI.
+typedef struct {
+    DensityMap density;
+    int ships_afloat[MAX_SHIPS]; // Ships not yet sunk, per fleet length slot.
+    Bitboard open_hits;          // Hits on ships that are not sunk yet.
+} NightmareState;
+
+// Opening book for the nightmare AI. Until its first hit, the AI's hunt shots
+// depend only on its earlier misses, so every game starts down the same line
+// of shots. The line is generated once per board and fleet with
+// --write-opening-book and kept in OPENING_BOOKS; engine_init() picks the book
+// for the configured game, if there is one.
+#define OPENING_BOOK_DEPTH 24
+#define OPENING_BOOK_SHIPS 16
+
+typedef struct {
+    int board_size;
+    int num_ships;
+    int ship_sizes[OPENING_BOOK_SHIPS];
+    int depth;                                // Shots in the line.
+    unsigned char cells[OPENING_BOOK_DEPTH];  // Shot n, if the n shots before it all missed.
+} OpeningBook;
+
+extern const OpeningBook OPENING_BOOKS[];
+extern const int NUM_OPENING_BOOKS;
+
+// --no-book plays every shot from the live density map; read by engine_init().
+extern bool use_opening_book;
+
+// One game in progress, driven from outside: a human's shot is handed in with
+// game_submit_move() and game_advance() plays a computer's turn. Nothing here
+// reads input or waits, so one thread can run any number of games.
+typedef struct {
+    const char *name;    // Shown in turn headers and announced as the winner.
+    const Strategy *ai;  // NULL for a human player.
+    void *ai_state;
+    Board fleet;         // Own ships, with the opponent's shots on them.
+    Board guess;         // What this player knows about the opponent's fleet.
+} GamePlayer;
+
+typedef enum {
+    GAME_AWAITING_MOVE,  // A human is to move: call game_submit_move().
+    GAME_COMPUTER_TURN,  // A computer is to move: call game_advance().
+    GAME_OVER
+} GameStatus;
+
+typedef enum {
+    MOVE_ACCEPTED,
+    MOVE_INVALID,      // Off the board.
+    MOVE_REPEATED,     // Already attacked.
+    MOVE_NOT_ALLOWED   // Not a human's turn, or the game is over.
+} MoveResult;
+
+typedef struct {
+    GamePlayer players[2];
+    int turn;    // Index of the player to move.
+    int winner;  // Index of the winner, or -1 while the game is running.
+    Rng rng;     // Fleet placement and the computers' shots.
+} Game;
+
+// A game cut down to what cannot be recomputed: both fleets, the cells each
+// side has fired at, and the random generator. Hit, miss and sunk layers, guess
+// boards and packable strategies' state all follow from replaying the shots,
+// which game_unpack() does. 64 bytes on the 10x10 board, 120 on 16x16.
+typedef struct {
+    Rng rng;
+    Bitboard attacked[2];           // Cells each player has fired at.
+    uint16_t fleets[2][MAX_SHIPS];  // cell << 1 | horizontal, per ship in SHIP_SIZES order.
+    unsigned char ai[2];            // STRATEGIES index + 1, or 0 for a human.
+    unsigned char turn;
+    signed char winner;
+} PackedGame;
+
+// Fixed-size objects handed out from slabs and recycled through a free list.
+typedef struct {
+    size_t object_size;
+    int per_slab;
+    void *free_list;
+    struct Slab *slabs;
+    long in_use;    // Objects handed out and not yet freed.
+    long capacity;  // Objects in all slabs.
+} Pool;
+
+// -----------------------------------------------------------------------------
+// Function Prototypes
+// -----------------------------------------------------------------------------
+
+// Engine setup: optionally choose the board and fleet, then fill in the bitboard
+// masks and placement tables and pick the density kernel. Call engine_init()
+// once before anything else.
+bool engine_configure(int size, const int *ship_sizes, int num_ships);
+void engine_init(void);
+
+// Board functions
+void initialize_board(Board *board);
+void print_board(const Board *board, bool reveal_ships);
+void print_boards(const Board *left, bool reveal_left, const Board *right, bool reveal_right);
+bool place_ship(Board *board, int size, bool horizontal, int x, int y);
+bool place_ships_random(Board *board, Rng *rng);
+bool place_ships_sequential(Board *board, Rng *rng);
+bool place_ships_uniform(Board *board, Rng *rng, int max_attempts);
+AttackResult process_attack(Board *board, int x, int y);
+void record_attack(Board *guess_board, const Board *target, int x, int y, AttackResult result);
+bool check_victory(const Board *board);
+bool update_board_for_destroyed_ship(Board *board, int ship);
+const Ship *ship_at(const Board *board, int x, int y);
+
+// Manual ship placement (for player input)
+void manual_place_ships(Board *board, const char *playerName);
+
+// Standard AI functions (Easy/Medium)
+void density_init(DensityMap *map);
+void density_block(DensityMap *map, Bitboard blocked, const int *weights);
+void add_target_candidates(StandardState *state, int x, int y, const Board *guess);
+
+// Nightmare mode AI (Hard mode); the exact AI shares its state and falls back on it.
+void *nightmare_init(void);
+void nightmare_reset(void *state);
+void nightmare_choose_shot(void *state, const Board *guess, Rng *rng, int *x, int *y);
+void nightmare_observe_result(void *state, const Board *guess, int x, int y, AttackResult result, int sunk_size);
+void init_opening_book(void);
+int write_opening_book(FILE *out, int depth);
+
+// Exact mode AI (Monte Carlo posterior over whole fleets)
+typedef struct {
+    double budget_ms;  // Wall-clock sampling budget per move (0 = max_samples only).
+    long max_samples;  // Stop after this many consistent fleets per move (0 = budget only).
+    int threads;       // Sampling threads per move (0 = all online CPUs).
+} ExactConfig;
+
+extern ExactConfig exact_config;
+
+// Strategy registry
+extern const Strategy STANDARD_STRATEGY, NIGHTMARE_STRATEGY, EXACT_STRATEGY;
+extern const Strategy *const STRATEGIES[];  // The first one is the default.
+extern const int NUM_STRATEGIES;
+
+const Strategy *find_strategy(const char *name);
+void *start_strategy(const Strategy *strategy);
+
+// Game state machine
+void game_init(Game *game, const char *name1, const Strategy *ai1,
+               const char *name2, const Strategy *ai2, uint64_t seed);
+void game_restart(Game *game, uint64_t seed);
+void game_free(Game *game);
+GameStatus game_status(const Game *game);
+MoveResult game_submit_move(Game *game, int x, int y, const GameObserver *observer);
+bool game_advance(Game *game, const GameObserver *observer);
+bool parse_cell(const char *text, int *x, int *y);
+bool game_pack(const Game *game, PackedGame *packed);
+void game_unpack(const PackedGame *packed, Game *game, const char *name1, const char *name2);
+void game_unpack_boards(const PackedGame *packed, Game *game);
+
+// Object pool
+void pool_init(Pool *pool, size_t object_size, int per_slab);
+void *pool_alloc(Pool *pool);
+void pool_free(Pool *pool, void *object);
+void pool_destroy(Pool *pool);
+
+// Utility functions
+void display_rules();
+void wait_for_enter();
+
+extern const GameObserver TERMINAL_OBSERVER;
+
+// Interactive games: both players place their fleets by hand, the player
+// places theirs and plays against a computer strategy on a random fleet, or
+// two computers play while the terminal watches.
+void play_player_vs_player(void);
+void play_player_vs_computer(const Strategy *ai, Rng *rng);
+void play_computer_vs_computer(const Strategy *ai1, const Strategy *ai2, Rng *rng);
+
+// Headless batch simulation (Computer vs Computer)
+typedef struct {
+    int winner;        // 1 or 2.
+    int winner_shots;  // Shots fired by the winner.
+} GameResult;
+
+// Everything needed to check a replayed game: both fleets and every shot in
+// order, computer 1 first, each packed into 16 bits.
+typedef struct {
+    uint16_t fleets[2][MAX_SHIPS];    // cell << 1 | horizontal, per ship in SHIP_SIZES order.
+    uint16_t shots[2 * MAX_BOARD_CELLS];  // cell << 2 | AttackResult.
+    int num_shots;
+} GameRecord;
+
+// Running totals for a batch, in fixed memory. Histograms are indexed by the
+// player's own shot number; bucket 0 of first_hit counts games without a hit.
+typedef struct {
+    long games;
+    long wins[2];
+    long long winner_shots;                 // Sum of shots fired by the winners.
+    long shots_to_win[2][MAX_BOARD_CELLS + 1];  // Per winning player.
+    long first_hit[2][MAX_BOARD_CELLS + 1];     // Shot of each player's first hit.
+    long hits[2][MAX_BOARD_CELLS];              // Hits each player landed per cell.
+} GameStats;
+
+typedef struct {
+    long games;
+    int threads;             // 0 = all online CPUs.
+    const Strategy *ai[2];
+    uint64_t seed;
+    const char *log_path;    // Binary game log, or NULL.
+    const char *stats_path;  // Statistics snapshots, or NULL.
+    long stats_every;        // Games between snapshots.
+    bool stats_json;         // JSON lines instead of CSV rows.
+} BatchConfig;
+
+GameResult simulate_game(const Strategy *ai1, void *ai_state1, const Strategy *ai2, void *ai_state2,
+                         Rng *rng, GameRecord *record);
+void stats_add_game(GameStats *stats, const GameRecord *record, GameResult result);
+void stats_merge(GameStats *into, const GameStats *from);
+void stats_write_csv_header(FILE *out);
+void stats_write_snapshot(FILE *out, const GameStats *stats, double elapsed, bool json);
+int run_batch(const BatchConfig *config);
+int run_replay(const char *log_path);
+
+int default_thread_count();
+double elapsed_seconds(const struct timespec *start, const struct timespec *end);
+
+// Benchmarks
+int run_density_benchmark(long iterations);
+int run_placement_benchmark(long samples);
+
+// -----------------------------------------------------------------------------
+// Turns
+// -----------------------------------------------------------------------------
+
+// Reports one attack: the shot, then a hit or miss, then a sink if there was one.
+static inline void report_attack(const GameObserver *observer, const char *shooter, int x, int y,
+                                 AttackResult result, int sunk_size) {
+    if (!observer)
+        return;
+    if (observer->shot)
+        observer->shot(observer->context, shooter, x, y);
+    if (result == ATTACK_MISS) {
+        if (observer->miss)
+            observer->miss(observer->context, shooter, x, y);
+        return;
+    }
+    if (observer->hit)
+        observer->hit(observer->context, shooter, x, y);
+    if (result == ATTACK_SUNK && observer->sink)
+        observer->sink(observer->context, shooter, x, y, sunk_size);
+}
+
+static inline void report_victory(const GameObserver *observer, const char *winner) {
+    if (observer && observer->victory)
+        observer->victory(observer->context, winner);
+}
+
+// Lets the strategy pick a cell, fires at it, records the outcome on the
+// strategy's guess board and reports it back. The cell fired at is stored in
+// `cell` unless it is NULL.
+static inline AttackResult computer_turn(const Strategy *strategy, void *state, Board *target, Board *guess,
+                                         Rng *rng, const GameObserver *observer, int *cell) {
+    int x, y;
+    strategy->choose_shot(state, guess, rng, &x, &y);
+    if (cell)
+        *cell = cell_index(x, y);
+    AttackResult result = process_attack(target, x, y);
+    record_attack(guess, target, x, y, result);
+    int sunk_size = result == ATTACK_SUNK ? ship_at(target, x, y)->size : 0;
+    if (observer) {
+        char shooter[32];
+        snprintf(shooter, sizeof(shooter), "Computer (%s)", strategy->label);
+        report_attack(observer, shooter, x, y, result, sunk_size);
+    }
+    strategy->observe_result(state, guess, x, y, result, sunk_size);
+    return result;
+}
+
+#endif
+
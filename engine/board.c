@@ -0,0 +1,442 @@
+#include "battleships.h"
+
+static bool place_ships_search(Board *board, Rng *rng);
+
+// -----------------------------------------------------------------------------
+// Fleet Search
+// -----------------------------------------------------------------------------
+
+// Depth-first search for a fleet without overlaps. Placements are numbered
+// cell << 1 | horizontal on a size x size board; ships are searched longest
+// first, each starting from its own offset into the placements.
+typedef struct {
+    int size;
+    int num_ships;
+    int ship[MAX_SHIPS];     // Fleet index of each ship, in search order.
+    int length[MAX_SHIPS];   // Its length.
+    int offset[MAX_SHIPS];   // Placement the ship's search starts from.
+    int choice[MAX_SHIPS];   // Placement found for it.
+} FleetSearch;
+
+static void fleet_search_init(FleetSearch *search, int size, const int *ship_sizes, int num_ships) {
+    search->size = size;
+    search->num_ships = num_ships;
+    for (int i = 0; i < num_ships; i++) {
+        int s = i;
+        while (s > 0 && search->length[s - 1] < ship_sizes[i]) {
+            search->ship[s] = search->ship[s - 1];
+            search->length[s] = search->length[s - 1];
+            s--;
+        }
+        search->ship[s] = i;
+        search->length[s] = ship_sizes[i];
+        search->offset[i] = 0;
+    }
+}
+
+// Cells covered by a placement, or an empty mask if it leaves the board.
+static Bitboard search_mask(int size, int length, int placement) {
+    Bitboard mask = { { 0 } };
+    int cell = placement >> 1;
+    bool horizontal = placement & 1;
+    if (horizontal ? cell % size + length > size : cell / size + length > size)
+        return mask;
+    for (int i = 0; i < length; i++)
+        bb_set(&mask, horizontal ? cell + i : cell + i * size);
+    return mask;
+}
+
+// Places ships `from` onwards around `occupied`. Ships of the same length take
+// increasing placements, so each layout is only tried once and an impossible
+// fleet is ruled out quickly.
+static bool search_fleet(FleetSearch *search, int from, Bitboard occupied) {
+    if (from == search->num_ships)
+        return true;
+    int length = search->length[from];
+    int count = 2 * search->size * search->size;
+    int after = from > 0 && search->length[from - 1] == length ? search->choice[from - 1] : -1;
+    for (int n = 0; n < count; n++) {
+        int placement = (search->offset[from] + n) % count;
+        // Length-1 ships only need one orientation.
+        if (placement <= after || (length == 1 && (placement & 1)))
+            continue;
+        Bitboard mask = search_mask(search->size, length, placement);
+        if (bb_is_empty(mask) || bb_intersects(mask, occupied))
+            continue;
+        search->choice[from] = placement;
+        if (search_fleet(search, from + 1, bb_or(occupied, mask)))
+            return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+
+#ifdef RUNTIME_BOARD
+int runtime_board_size = 10;
+int SHIP_SIZES[MAX_SHIPS] = { 5, 3, 2, 2, 1 };
+int NUM_SHIPS = 5;
+#endif
+
+// Sets the board size and fleet; must be called before engine_init(). The
+// fallback engine accepts any size up to MAX_BOARD_SIZE and up to MAX_SHIPS
+// ships that can all be placed on the board together. Specialised engines only
+// accept the board and fleet they were compiled for. Returns false if the game
+// is not supported.
+bool engine_configure(int size, const int *ship_sizes, int num_ships) {
+    if (size < 1 || size > MAX_BOARD_SIZE || num_ships < 1 || num_ships > MAX_SHIPS)
+        return false;
+    int ship_cells = 0;
+    for (int i = 0; i < num_ships; i++) {
+        if (ship_sizes[i] < 1 || ship_sizes[i] > size)
+            return false;
+        ship_cells += ship_sizes[i];
+    }
+    if (ship_cells > size * size)
+        return false;
+    FleetSearch search;
+    Bitboard empty = { { 0 } };
+    fleet_search_init(&search, size, ship_sizes, num_ships);
+    if (!search_fleet(&search, 0, empty))
+        return false;
+#ifdef RUNTIME_BOARD
+    runtime_board_size = size;
+    memcpy(SHIP_SIZES, ship_sizes, sizeof(int) * num_ships);
+    NUM_SHIPS = num_ships;
+    return true;
+#else
+    return size == BOARD_SIZE && num_ships == NUM_SHIPS &&
+           memcmp(ship_sizes, SHIP_SIZES, sizeof(int) * num_ships) == 0;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Bitboards
+// -----------------------------------------------------------------------------
+
+Bitboard BOARD_MASK, FIRST_COLUMN, LAST_COLUMN;
+
+static void init_bitboards() {
+    for (int x = 0; x < BOARD_SIZE; x++) {
+        for (int y = 0; y < BOARD_SIZE; y++)
+            bb_set(&BOARD_MASK, cell_index(x, y));
+        bb_set(&FIRST_COLUMN, cell_index(x, 0));
+        bb_set(&LAST_COLUMN, cell_index(x, BOARD_SIZE - 1));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Placement Tables
+// -----------------------------------------------------------------------------
+
+int FLEET_LENGTHS[MAX_SHIPS];
+int FLEET_LENGTH_COUNT[MAX_SHIPS];
+int NUM_FLEET_LENGTHS;
+
+Placement PLACEMENTS[MAX_SHIPS][MAX_PLACEMENTS];
+int NUM_PLACEMENTS[MAX_SHIPS];
+
+unsigned short COVERING[MAX_SHIPS][MAX_BOARD_CELLS][MAX_COVERING];
+unsigned char NUM_COVERING[MAX_SHIPS][MAX_BOARD_CELLS];
+
+static void add_placement(int slot, int x, int y, bool horizontal) {
+    int size = FLEET_LENGTHS[slot];
+    int index = NUM_PLACEMENTS[slot]++;
+    Placement *p = &PLACEMENTS[slot][index];
+    p->cell = (unsigned char)cell_index(x, y);
+    p->step = (unsigned char)(horizontal ? 1 : BOARD_SIZE);
+    p->size = (unsigned char)size;
+    memset(&p->cells, 0, sizeof(p->cells));
+    for (int k = 0, cell = p->cell; k < size; k++, cell += p->step) {
+        bb_set(&p->cells, cell);
+        COVERING[slot][cell][NUM_COVERING[slot][cell]++] = (unsigned short)index;
+    }
+}
+
+// Slot of the fleet length `size`, or -1 if no ship has that length.
+int fleet_slot(int size) {
+    for (int k = 0; k < NUM_FLEET_LENGTHS; k++)
+        if (FLEET_LENGTHS[k] == size)
+            return k;
+    return -1;
+}
+
+static void init_placements() {
+    for (int s = 0; s < NUM_SHIPS; s++) {
+        int k = 0;
+        while (k < NUM_FLEET_LENGTHS && FLEET_LENGTHS[k] != SHIP_SIZES[s])
+            k++;
+        if (k == NUM_FLEET_LENGTHS) {
+            FLEET_LENGTHS[k] = SHIP_SIZES[s];
+            NUM_FLEET_LENGTHS++;
+        }
+        FLEET_LENGTH_COUNT[k]++;
+    }
+    for (int k = 0; k < NUM_FLEET_LENGTHS; k++) {
+        int size = FLEET_LENGTHS[k];
+        for (int x = 0; x < BOARD_SIZE; x++)
+            for (int y = 0; y + size <= BOARD_SIZE; y++)
+                add_placement(k, x, y, true);
+        for (int y = 0; y < BOARD_SIZE; y++)
+            for (int x = 0; x + size <= BOARD_SIZE; x++)
+                add_placement(k, x, y, false);
+    }
+}
+
+void engine_init(void) {
+    init_bitboards();
+    init_placements();
+    init_density_kernel();
+    init_opening_book();
+}
+
+// -----------------------------------------------------------------------------
+// Board Function Implementations
+// -----------------------------------------------------------------------------
+
+void initialize_board(Board *board) {
+    memset(board, 0, sizeof(*board));
+}
+
+// Mask of the ship cells covered by a placement, or an empty mask if it leaves the board.
+static Bitboard placement_mask(int size, bool horizontal, int x, int y) {
+    Bitboard mask = { { 0 } };
+    if (x < 0 || y < 0 || x >= BOARD_SIZE || y >= BOARD_SIZE)
+        return mask;
+    if (horizontal ? y + size > BOARD_SIZE : x + size > BOARD_SIZE)
+        return mask;
+    int step = horizontal ? 1 : BOARD_SIZE;
+    for (int i = 0, cell = cell_index(x, y); i < size; i++, cell += step)
+        bb_set(&mask, cell);
+    return mask;
+}
+
+bool place_ship(Board *board, int size, bool horizontal, int x, int y) {
+    if (board->num_ships >= MAX_SHIPS)
+        return false;
+    Bitboard mask = placement_mask(size, horizontal, x, y);
+    if (bb_is_empty(mask) || bb_intersects(mask, board->ships))
+        return false;
+    board->ships = bb_or(board->ships, mask);
+    board->intact_cells += size;
+
+    int id = board->num_ships++;
+    Ship *ship = &board->fleet[id];
+    ship->cells = mask;
+    ship->size = (unsigned char)size;
+    ship->remaining = (unsigned char)size;
+    ship->x = (unsigned char)x;
+    ship->y = (unsigned char)y;
+    ship->horizontal = horizontal;
+    int step = horizontal ? 1 : BOARD_SIZE;
+    for (int i = 0, cell = cell_index(x, y); i < size; i++, cell += step)
+        board->ship_at[cell] = (unsigned char)(id + 1);
+    return true;
+}
+
+// Places a random fleet. Uses the uniform sampler, falling back to the
+// sequential one if the fleet is so cramped that whole-fleet draws keep failing,
+// and to a full search from random starting points if even that fails. Always
+// succeeds on an empty board, since engine_configure() only accepts fleets
+// that fit.
+bool place_ships_random(Board *board, Rng *rng) {
+    return place_ships_uniform(board, rng, 10000) || place_ships_sequential(board, rng) ||
+           place_ships_search(board, rng);
+}
+
+// Searches for a fleet that fits around the ships already on the board,
+// starting each ship at a random placement. Finds one whenever one exists, but
+// the fleets it finds are far from uniform.
+static bool place_ships_search(Board *board, Rng *rng) {
+    FleetSearch search;
+    fleet_search_init(&search, BOARD_SIZE, SHIP_SIZES, NUM_SHIPS);
+    for (int i = 0; i < NUM_SHIPS; i++)
+        search.offset[i] = rng_below(rng, 2 * BOARD_CELLS);
+    if (!search_fleet(&search, 0, board->ships))
+        return false;
+    int placement[MAX_SHIPS];
+    for (int s = 0; s < NUM_SHIPS; s++)
+        placement[search.ship[s]] = search.choice[s];
+    for (int i = 0; i < NUM_SHIPS; i++) {
+        int cell = placement[i] >> 1;
+        place_ship(board, SHIP_SIZES[i], placement[i] & 1, cell / BOARD_SIZE, cell % BOARD_SIZE);
+    }
+    return true;
+}
+
+// Places the fleet in SHIP_SIZES order, each ship drawn uniformly from the
+// placements that do not overlap the ships already on the board. Every draw
+// succeeds unless earlier ships left no room at all, in which case the fleet is
+// started over; returns false (with the board unchanged) if that keeps happening.
+// Biased: ships placed first get the open board to themselves, which skews
+// where the fleet ends up (see --bench-placement).
+bool place_ships_sequential(Board *board, Rng *rng) {
+    const int max_restarts = 100;
+    Board empty = *board;
+    unsigned short legal[MAX_PLACEMENTS];
+    for (int restart = 0; restart < max_restarts; restart++) {
+        *board = empty;
+        bool complete = true;
+        for (int i = 0; i < NUM_SHIPS && complete; i++) {
+            int slot = fleet_slot(SHIP_SIZES[i]);
+            int num_legal = 0;
+            for (int n = 0; n < NUM_PLACEMENTS[slot]; n++) {
+                const Placement *p = &PLACEMENTS[slot][n];
+                // Length-1 ships are listed once per orientation; keep one copy.
+                if (p->size == 1 && p->step != 1)
+                    continue;
+                if (!bb_intersects(p->cells, board->ships))
+                    legal[num_legal++] = (unsigned short)n;
+            }
+            if (num_legal == 0) {
+                complete = false;
+                break;
+            }
+            const Placement *p = &PLACEMENTS[slot][legal[rng_below(rng, num_legal)]];
+            place_ship(board, p->size, p->step == 1, p->cell / BOARD_SIZE, p->cell % BOARD_SIZE);
+        }
+        if (complete)
+            return true;
+    }
+    *board = empty;
+    return false;
+}
+
+// Draws every ship independently from all of its placements and keeps the fleet
+// only if no two ships overlap, so every legal fleet is equally likely. Returns
+// false (with the board unchanged) after max_attempts rejected fleets.
+bool place_ships_uniform(Board *board, Rng *rng, int max_attempts) {
+    const Placement *chosen[MAX_SHIPS];
+    for (int attempt = 0; attempt < max_attempts; attempt++) {
+        Bitboard occupied = board->ships;
+        int placed = 0;
+        for (; placed < NUM_SHIPS; placed++) {
+            int slot = fleet_slot(SHIP_SIZES[placed]);
+            const Placement *p = &PLACEMENTS[slot][rng_below(rng, NUM_PLACEMENTS[slot])];
+            if (bb_intersects(p->cells, occupied))
+                break;
+            occupied = bb_or(occupied, p->cells);
+            chosen[placed] = p;
+        }
+        if (placed < NUM_SHIPS)
+            continue;
+        for (int i = 0; i < NUM_SHIPS; i++) {
+            const Placement *p = chosen[i];
+            place_ship(board, p->size, p->step == 1, p->cell / BOARD_SIZE, p->cell % BOARD_SIZE);
+        }
+        return true;
+    }
+    return false;
+}
+
+AttackResult process_attack(Board *board, int x, int y) {
+    int cell = cell_index(x, y);
+    if (bb_test(&board->hits, cell) || bb_test(&board->misses, cell))
+        return ATTACK_MISS;
+    if (board->ship_at[cell]) {
+        bb_set(&board->hits, cell);
+        board->intact_cells--;
+        if (update_board_for_destroyed_ship(board, board->ship_at[cell] - 1))
+            return ATTACK_SUNK;
+        return ATTACK_HIT;
+    }
+    bb_set(&board->misses, cell);
+    return ATTACK_MISS;
+}
+
+// Marks the outcome of an attack on the attacker's own view of the opponent.
+// A sink reveals every cell of the destroyed ship.
+void record_attack(Board *guess_board, const Board *target, int x, int y, AttackResult result) {
+    int cell = cell_index(x, y);
+    if (result == ATTACK_MISS) {
+        bb_set(&guess_board->misses, cell);
+        return;
+    }
+    bb_set(&guess_board->hits, cell);
+    if (result == ATTACK_SUNK)
+        guess_board->sunk = bb_or(guess_board->sunk, ship_at(target, x, y)->cells);
+}
+
+bool check_victory(const Board *board) {
+    return board->intact_cells == 0;
+}
+
+// Returns the ship occupying (x, y), or NULL for water.
+const Ship *ship_at(const Board *board, int x, int y) {
+    int id = board->ship_at[cell_index(x, y)];
+    return id ? &board->fleet[id - 1] : NULL;
+}
+
+// Called once per hit on the given ship; marks it destroyed ('0') when its last
+// intact part is hit. Returns true if the ship sank.
+bool update_board_for_destroyed_ship(Board *board, int ship) {
+    Ship *s = &board->fleet[ship];
+    if (s->remaining == 0 || --s->remaining > 0)
+        return false;
+    board->sunk = bb_or(board->sunk, s->cells);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks
+// -----------------------------------------------------------------------------
+
+// Times the sequential and uniform fleet samplers and prints how often each cell
+// ends up under a ship, so any bias in the sequential sampler shows up directly.
+int run_placement_benchmark(long samples) {
+    struct {
+        const char *name;
+        double occupancy[MAX_BOARD_CELLS];
+    } samplers[2] = { { "sequential", { 0 } }, { "uniform", { 0 } } };
+
+    printf("Fleet placement benchmark (%ld fleets per sampler)\n", samples);
+    for (int k = 0; k < 2; k++) {
+        long counts[MAX_BOARD_CELLS] = { 0 };
+        long failures = 0;
+        Rng rng;
+        rng_seed(&rng, 12345);
+        struct timespec start, end;
+        timespec_get(&start, TIME_UTC);
+        for (long n = 0; n < samples; n++) {
+            Board board;
+            initialize_board(&board);
+            bool placed = k == 0 ? place_ships_sequential(&board, &rng)
+                                 : place_ships_uniform(&board, &rng, 10000);
+            if (!placed) {
+                failures++;
+                continue;
+            }
+            Bitboard cells = board.ships;
+            while (!bb_is_empty(cells))
+                counts[bb_pop_lowest(&cells)]++;
+        }
+        timespec_get(&end, TIME_UTC);
+        double seconds = elapsed_seconds(&start, &end);
+        long placed = samples - failures;
+        for (int cell = 0; cell < BOARD_CELLS; cell++)
+            samplers[k].occupancy[cell] = placed > 0 ? 100.0 * counts[cell] / placed : 0.0;
+        printf("  %-10s %12.0f fleets/s  (%ld failed)\n", samplers[k].name,
+               seconds > 0 ? samples / seconds : 0.0, failures);
+    }
+
+    for (int k = 0; k <= 2; k++) {
+        double max_delta = 0;
+        printf("\n%s\n", k < 2 ? samplers[k].name : "sequential - uniform (percentage points)");
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                int cell = cell_index(i, j);
+                double value = k < 2 ? samplers[k].occupancy[cell]
+                                     : samplers[0].occupancy[cell] - samplers[1].occupancy[cell];
+                if (value > max_delta || -value > max_delta)
+                    max_delta = value > 0 ? value : -value;
+                printf(k < 2 ? "%6.1f" : "%+6.1f", value);
+            }
+            printf("\n");
+        }
+        if (k == 2)
+            printf("Largest difference: %.2f percentage points\n", max_delta);
+    }
+    return 0;
+}
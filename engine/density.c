@@ -0,0 +1,261 @@
+#include "battleships.h"
+#ifdef HAVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// Density Kernels
+// -----------------------------------------------------------------------------
+
+// The SSE2 and AVX2 kernels compute the same grid as the scalar loops. They need
+// BOARD_SIZE <= 16 and every count to fit in a byte; init_density_kernel() falls
+// back to the scalar loops otherwise.
+
+// Reference implementation: the sliding-window loops the nightmare AI has always used.
+void density_kernel_scalar(Bitboard blocked, const int *weights, DensityGrid out) {
+    unsigned row_blocked[MAX_BOARD_SIZE], col_blocked[MAX_BOARD_SIZE] = {0};
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        row_blocked[i] = row_bits(blocked, i);
+        for (int j = 0; j < BOARD_SIZE; j++)
+            col_blocked[j] |= ((row_blocked[i] >> j) & 1u) << i;
+    }
+    memset(out, 0, sizeof(DensityGrid));
+    for (int k = 0; k < NUM_FLEET_LENGTHS; k++) {
+        int size = FLEET_LENGTHS[k];
+        int weight = weights[k];
+        unsigned window = (1u << size) - 1;
+        if (weight == 0)
+            continue;
+        for (int i = 0; i < BOARD_SIZE; i++)
+            for (int j = 0; j <= BOARD_SIZE - size; j++)
+                if (!((row_blocked[i] >> j) & window))
+                    for (int n = 0; n < size; n++)
+                        out[i][j + n] += weight;
+        for (int j = 0; j < BOARD_SIZE; j++)
+            for (int i = 0; i <= BOARD_SIZE - size; i++)
+                if (!((col_blocked[j] >> i) & window))
+                    for (int n = 0; n < size; n++)
+                        out[i + n][j] += weight;
+    }
+}
+
+#if defined(HAVE_X86_KERNELS) && MAX_BOARD_SIZE <= 16
+// One byte per cell, 1 where the cell is not blocked (padding bytes are 0).
+static inline __m128i free_row_sse2(Bitboard blocked, int row) {
+    unsigned free_bits = ~row_bits(blocked, row) & ((1u << BOARD_SIZE) - 1);
+    const __m128i select = _mm_set_epi8((char)0x80, 0x40, 0x20, 0x10, 8, 4, 2, 1,
+                                        (char)0x80, 0x40, 0x20, 0x10, 8, 4, 2, 1);
+    __m128i spread = _mm_set_epi64x((long long)((free_bits >> 8) * 0x0101010101010101ULL),
+                                    (long long)((free_bits & 0xFF) * 0x0101010101010101ULL));
+    __m128i set = _mm_cmpeq_epi8(_mm_and_si128(spread, select), select);
+    return _mm_and_si128(set, _mm_set1_epi8(1));
+}
+
+// Horizontal windows are byte shifts within a row; vertical windows combine whole rows.
+static void density_kernel_sse2(Bitboard blocked, const int *weights, DensityGrid out) {
+    __m128i rows[MAX_BOARD_SIZE], acc[MAX_BOARD_SIZE];
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        rows[i] = free_row_sse2(blocked, i);
+        acc[i] = _mm_setzero_si128();
+    }
+    for (int k = 0; k < NUM_FLEET_LENGTHS; k++) {
+        int size = FLEET_LENGTHS[k];
+        int weight = weights[k];
+        if (weight == 0)
+            continue;
+        __m128i starts[MAX_BOARD_SIZE];
+        for (int i = 0; i < BOARD_SIZE; i++)
+            starts[i] = i + size <= BOARD_SIZE ? rows[i] : _mm_setzero_si128();
+        for (int i = 0; i + size <= BOARD_SIZE; i++)
+            for (int n = 1; n < size; n++)
+                starts[i] = _mm_and_si128(starts[i], rows[i + n]);
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            __m128i start = rows[i], shifted = rows[i];
+            for (int n = 1; n < size; n++) {
+                shifted = _mm_srli_si128(shifted, 1);
+                start = _mm_and_si128(start, shifted);
+            }
+            __m128i cover = start;
+            for (int n = 1; n < size; n++) {
+                start = _mm_slli_si128(start, 1);
+                cover = _mm_add_epi8(cover, start);
+            }
+            for (int n = 0; n < size && n <= i; n++)
+                cover = _mm_add_epi8(cover, starts[i - n]);
+            for (int w = 0; w < weight; w++)
+                acc[i] = _mm_add_epi8(acc[i], cover);
+        }
+    }
+    for (int i = 0; i < BOARD_SIZE; i++)
+        _mm_storeu_si128((__m128i *)out[i], acc[i]);
+}
+
+// Two rows per register: (row 2m, row 2m + 1). Moving a whole grid up or down by
+// one row is a cross-lane permute of neighbouring registers.
+#define ROW_PAIRS ((BOARD_SIZE + 1) / 2)
+#define MAX_ROW_PAIRS ((MAX_BOARD_SIZE + 1) / 2)
+
+__attribute__((target("avx2")))
+static inline __m256i rows_up_avx2(const __m256i *grid, int m) {
+    __m256i next = m + 1 < ROW_PAIRS ? grid[m + 1] : _mm256_setzero_si256();
+    return _mm256_permute2x128_si256(grid[m], next, 0x21);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i rows_down_avx2(const __m256i *grid, int m) {
+    __m256i prev = m > 0 ? grid[m - 1] : _mm256_setzero_si256();
+    return _mm256_permute2x128_si256(prev, grid[m], 0x21);
+}
+
+__attribute__((target("avx2")))
+static void density_kernel_avx2(Bitboard blocked, const int *weights, DensityGrid out) {
+    __m256i rows[MAX_ROW_PAIRS], acc[MAX_ROW_PAIRS];
+    for (int m = 0; m < ROW_PAIRS; m++) {
+        __m128i lo = free_row_sse2(blocked, 2 * m);
+        __m128i hi = 2 * m + 1 < BOARD_SIZE ? free_row_sse2(blocked, 2 * m + 1) : _mm_setzero_si128();
+        rows[m] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        acc[m] = _mm256_setzero_si256();
+    }
+    for (int k = 0; k < NUM_FLEET_LENGTHS; k++) {
+        int size = FLEET_LENGTHS[k];
+        int weight = weights[k];
+        if (weight == 0)
+            continue;
+        __m256i below[MAX_ROW_PAIRS], starts[MAX_ROW_PAIRS], tmp[MAX_ROW_PAIRS], cover[MAX_ROW_PAIRS];
+        // Vertical starts: AND of this row and the size - 1 rows below it.
+        for (int m = 0; m < ROW_PAIRS; m++)
+            below[m] = starts[m] = rows[m];
+        for (int n = 1; n < size; n++) {
+            for (int m = 0; m < ROW_PAIRS; m++)
+                tmp[m] = rows_up_avx2(below, m);
+            for (int m = 0; m < ROW_PAIRS; m++) {
+                below[m] = tmp[m];
+                starts[m] = _mm256_and_si256(starts[m], below[m]);
+            }
+        }
+        // Vertical cover: sum of the starts in this row and the size - 1 rows above it.
+        for (int m = 0; m < ROW_PAIRS; m++)
+            cover[m] = below[m] = starts[m];
+        for (int n = 1; n < size; n++) {
+            for (int m = 0; m < ROW_PAIRS; m++)
+                tmp[m] = rows_down_avx2(below, m);
+            for (int m = 0; m < ROW_PAIRS; m++) {
+                below[m] = tmp[m];
+                cover[m] = _mm256_add_epi8(cover[m], below[m]);
+            }
+        }
+        // Horizontal starts and cover, within each 128-bit lane (one row).
+        for (int m = 0; m < ROW_PAIRS; m++) {
+            __m256i start = rows[m], shifted = rows[m];
+            for (int n = 1; n < size; n++) {
+                shifted = _mm256_srli_si256(shifted, 1);
+                start = _mm256_and_si256(start, shifted);
+            }
+            __m256i total = _mm256_add_epi8(cover[m], start);
+            for (int n = 1; n < size; n++) {
+                start = _mm256_slli_si256(start, 1);
+                total = _mm256_add_epi8(total, start);
+            }
+            for (int w = 0; w < weight; w++)
+                acc[m] = _mm256_add_epi8(acc[m], total);
+        }
+    }
+    for (int m = 0; m < ROW_PAIRS; m++) {
+        _mm_storeu_si128((__m128i *)out[2 * m], _mm256_castsi256_si128(acc[m]));
+        if (2 * m + 1 < BOARD_SIZE)
+            _mm_storeu_si128((__m128i *)out[2 * m + 1], _mm256_extracti128_si256(acc[m], 1));
+    }
+}
+#endif
+
+DensityKernel density_kernel = density_kernel_scalar;
+const char *density_kernel_name = "scalar";
+
+void init_density_kernel(void) {
+    int max_count = 0;
+    for (int s = 0; s < NUM_SHIPS; s++)
+        max_count += 2 * SHIP_SIZES[s];
+    if (max_count > 255)
+        return;
+#if defined(HAVE_X86_KERNELS) && MAX_BOARD_SIZE <= 16
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        density_kernel = density_kernel_avx2;
+        density_kernel_name = "avx2";
+    } else {
+        density_kernel = density_kernel_sse2;
+        density_kernel_name = "sse2";
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks
+// -----------------------------------------------------------------------------
+
+// Times each available density kernel on the same random boards and checks that
+// they all agree with the scalar reference.
+int run_density_benchmark(long iterations) {
+    enum { NUM_BOARDS = 1024 };
+    static Bitboard boards[NUM_BOARDS];
+    Rng rng;
+    rng_seed(&rng, 12345);
+    for (int b = 0; b < NUM_BOARDS; b++) {
+        memset(&boards[b], 0, sizeof(boards[b]));
+        // Anything from an empty board to a late-game board.
+        int shots = rng_below(&rng, BOARD_CELLS / 2);
+        for (int n = 0; n < shots; n++)
+            bb_set(&boards[b], rng_below(&rng, BOARD_CELLS));
+    }
+
+    struct {
+        const char *name;
+        DensityKernel kernel;
+    } kernels[3];
+    int num_kernels = 0;
+    kernels[num_kernels].name = "scalar";
+    kernels[num_kernels++].kernel = density_kernel_scalar;
+#if defined(HAVE_X86_KERNELS) && MAX_BOARD_SIZE <= 16
+    if (density_kernel != density_kernel_scalar) {
+        kernels[num_kernels].name = "sse2";
+        kernels[num_kernels++].kernel = density_kernel_sse2;
+        if (density_kernel == density_kernel_avx2) {
+            kernels[num_kernels].name = "avx2";
+            kernels[num_kernels++].kernel = density_kernel_avx2;
+        }
+    }
+#endif
+
+    for (int b = 0; b < NUM_BOARDS; b++) {
+        DensityGrid expected, actual;
+        density_kernel_scalar(boards[b], FLEET_LENGTH_COUNT, expected);
+        for (int k = 1; k < num_kernels; k++) {
+            kernels[k].kernel(boards[b], FLEET_LENGTH_COUNT, actual);
+            for (int i = 0; i < BOARD_SIZE; i++) {
+                if (memcmp(expected[i], actual[i], BOARD_SIZE) != 0) {
+                    printf("Kernel %s disagrees with scalar on board %d.\n", kernels[k].name, b);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    printf("Density kernel benchmark (%ld boards, selected kernel: %s)\n", iterations, density_kernel_name);
+    double scalar_ns = 0;
+    for (int k = 0; k < num_kernels; k++) {
+        DensityGrid out;
+        unsigned checksum = 0;
+        struct timespec start, end;
+        timespec_get(&start, TIME_UTC);
+        for (long n = 0; n < iterations; n++) {
+            kernels[k].kernel(boards[n & (NUM_BOARDS - 1)], FLEET_LENGTH_COUNT, out);
+            checksum += out[n % BOARD_SIZE][n % BOARD_SIZE];
+        }
+        timespec_get(&end, TIME_UTC);
+        double ns = elapsed_seconds(&start, &end) * 1e9 / iterations;
+        if (k == 0)
+            scalar_ns = ns;
+        printf("  %-8s %8.1f ns/board  %6.2fx  (checksum %u)\n", kernels[k].name, ns, scalar_ns / ns, checksum);
+    }
+    return 0;
+}
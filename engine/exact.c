@@ -0,0 +1,167 @@
+#include <pthread.h>
+#include "battleships.h"
+
+ExactConfig exact_config = { 50.0, 0, 0 };
+
+// -----------------------------------------------------------------------------
+// Exact Mode AI
+// -----------------------------------------------------------------------------
+
+// The exact AI estimates, for every unknown cell, the probability that it holds a
+// ship given everything seen so far. It draws whole fleets of the afloat ships
+// from their legal placements, keeps the ones with no overlaps that cover every
+// open hit, and fires at the cell occupied most often. Since every ship is drawn
+// uniformly and only inconsistent fleets are thrown away, the kept fleets are a
+// uniform sample of all consistent configurations, so unlike the density map
+// this accounts for ships not overlapping each other.
+
+typedef struct {
+    int num_ships;
+    int slot[MAX_SHIPS];              // Fleet length slot of each afloat ship, largest first.
+    Bitboard options[MAX_SHIPS][MAX_PLACEMENTS]; // Per slot: placements avoiding misses and sunk cells.
+    int num_options[MAX_SHIPS];
+    Bitboard open_hits;               // Must all be covered.
+    Bitboard unknown;                 // Cells that can still be fired at.
+    struct timespec deadline;
+    bool timed;                       // Stop at the deadline as well as at max_samples.
+    long max_samples;                 // Per worker, 0 for no limit.
+} ExactProblem;
+
+typedef struct {
+    const ExactProblem *problem;
+    Rng rng;
+    long accepted;
+    unsigned counts[MAX_BOARD_CELLS];
+} ExactWorker;
+
+static bool deadline_passed(const struct timespec *deadline) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return now.tv_sec > deadline->tv_sec ||
+           (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+static void *exact_worker(void *arg) {
+    ExactWorker *worker = arg;
+    const ExactProblem *problem = worker->problem;
+    for (long tried = 0; ; tried++) {
+        if ((tried & 1023) == 0 && problem->timed && deadline_passed(&problem->deadline))
+            break;
+        if (problem->max_samples && worker->accepted >= problem->max_samples)
+            break;
+        Bitboard occupied = { { 0 } };
+        bool consistent = true;
+        for (int s = 0; s < problem->num_ships && consistent; s++) {
+            int slot = problem->slot[s];
+            Bitboard ship = problem->options[slot][rng_below(&worker->rng, problem->num_options[slot])];
+            consistent = !bb_intersects(occupied, ship);
+            occupied = bb_or(occupied, ship);
+        }
+        if (!consistent || !bb_is_empty(bb_andnot(problem->open_hits, occupied)))
+            continue;
+        worker->accepted++;
+        Bitboard cells = bb_and(occupied, problem->unknown);
+        while (!bb_is_empty(cells))
+            worker->counts[bb_pop_lowest(&cells)]++;
+    }
+    return NULL;
+}
+
+// Samples consistent fleets for up to exact_config's budget and sample limit and fires at the most
+// frequently occupied unknown cell. Falls back to the nightmare AI if no fleet
+// consistent with the observations was found in time; it shares the nightmare
+// AI's state, so either can pick any shot.
+static void exact_choose_shot(void *opaque, const Board *ai_guess, Rng *rng, int *x, int *y) {
+    NightmareState *state = opaque;
+    ExactProblem problem;
+    Bitboard blocked = bb_or(ai_guess->misses, ai_guess->sunk);
+    problem.open_hits = state->open_hits;
+    problem.unknown = bb_andnot(BOARD_MASK, bb_or(ai_guess->hits, ai_guess->misses));
+    problem.num_ships = 0;
+    for (int k = 0; k < NUM_FLEET_LENGTHS; k++) {
+        problem.num_options[k] = 0;
+        if (state->ships_afloat[k] == 0)
+            continue;
+        for (int n = 0; n < NUM_PLACEMENTS[k]; n++) {
+            const Placement *p = &PLACEMENTS[k][n];
+            // Length-1 ships are listed once per orientation; keep one copy.
+            if (p->size == 1 && p->step != 1)
+                continue;
+            if (!bb_intersects(p->cells, blocked))
+                problem.options[k][problem.num_options[k]++] = p->cells;
+        }
+        if (problem.num_options[k] == 0) {
+            nightmare_choose_shot(state, ai_guess, rng, x, y);
+            return;
+        }
+        // Insert this slot's ships keeping the largest first, so overlaps are found early.
+        for (int c = 0; c < state->ships_afloat[k]; c++) {
+            int s = problem.num_ships++;
+            while (s > 0 && FLEET_LENGTHS[problem.slot[s - 1]] < FLEET_LENGTHS[k]) {
+                problem.slot[s] = problem.slot[s - 1];
+                s--;
+            }
+            problem.slot[s] = k;
+        }
+    }
+
+    int threads = exact_config.threads > 0 ? exact_config.threads : default_thread_count();
+    if (threads > 64)
+        threads = 64;
+    timespec_get(&problem.deadline, TIME_UTC);
+    long budget_ns = (long)(exact_config.budget_ms * 1e6);
+    problem.deadline.tv_sec += budget_ns / 1000000000L;
+    problem.deadline.tv_nsec += budget_ns % 1000000000L;
+    if (problem.deadline.tv_nsec >= 1000000000L) {
+        problem.deadline.tv_sec++;
+        problem.deadline.tv_nsec -= 1000000000L;
+    }
+    problem.max_samples = exact_config.max_samples > 0 ? (exact_config.max_samples + threads - 1) / threads : 0;
+    // Without a budget the sample limit alone stops the search, so the shot only
+    // depends on the random generator; without either, nothing is sampled.
+    problem.timed = exact_config.budget_ms > 0 || problem.max_samples == 0;
+
+    ExactWorker workers[64];
+    pthread_t handles[64];
+    for (int t = 0; t < threads; t++) {
+        workers[t].problem = &problem;
+        rng_seed(&workers[t].rng, rng_next(rng));
+        workers[t].accepted = 0;
+        memset(workers[t].counts, 0, sizeof(workers[t].counts));
+        if (t == 0 || pthread_create(&handles[t], NULL, exact_worker, &workers[t]) != 0)
+            handles[t] = 0;
+    }
+    exact_worker(&workers[0]);
+    long accepted = workers[0].accepted;
+    for (int t = 1; t < threads; t++) {
+        if (handles[t])
+            pthread_join(handles[t], NULL);
+        else
+            exact_worker(&workers[t]);
+        accepted += workers[t].accepted;
+        for (int cell = 0; cell < BOARD_CELLS; cell++)
+            workers[0].counts[cell] += workers[t].counts[cell];
+    }
+
+    if (accepted == 0) {
+        nightmare_choose_shot(state, ai_guess, rng, x, y);
+        return;
+    }
+    int best_cell = -1;
+    unsigned best_count = 0;
+    Bitboard unknown = problem.unknown;
+    while (!bb_is_empty(unknown)) {
+        int cell = bb_pop_lowest(&unknown);
+        if (best_cell < 0 || workers[0].counts[cell] > best_count) {
+            best_cell = cell;
+            best_count = workers[0].counts[cell];
+        }
+    }
+    *x = best_cell / BOARD_SIZE;
+    *y = best_cell % BOARD_SIZE;
+}
+
+const Strategy EXACT_STRATEGY = {
+    "exact", "Exact",
+    nightmare_init, nightmare_reset, exact_choose_shot, nightmare_observe_result, free, true
+};
@@ -0,0 +1,213 @@
+#include "battleships.h"
+
+// -----------------------------------------------------------------------------
+// Game State Machine
+// -----------------------------------------------------------------------------
+
+// Sets up a game between two players; a NULL strategy makes that player human.
+// Computer fleets are placed at random here. Human fleets are left empty for
+// the caller to fill, by hand or with place_ships_random(&fleet, &game->rng).
+// Player 1 moves first.
+void game_init(Game *game, const char *name1, const Strategy *ai1,
+               const char *name2, const Strategy *ai2, uint64_t seed) {
+    const char *names[2] = { name1, name2 };
+    const Strategy *ais[2] = { ai1, ai2 };
+    for (int i = 0; i < 2; i++) {
+        GamePlayer *player = &game->players[i];
+        player->name = names[i];
+        player->ai = ais[i];
+        player->ai_state = ais[i] ? start_strategy(ais[i]) : NULL;
+    }
+    game_restart(game, seed);
+}
+
+// Starts a new game between the same players, as game_init() would, but resets
+// the computers' strategy state in place instead of allocating it again.
+void game_restart(Game *game, uint64_t seed) {
+    rng_seed(&game->rng, seed);
+    for (int i = 0; i < 2; i++) {
+        GamePlayer *player = &game->players[i];
+        if (player->ai)
+            player->ai->reset(player->ai_state);
+        initialize_board(&player->fleet);
+        initialize_board(&player->guess);
+        if (player->ai)
+            place_ships_random(&player->fleet, &game->rng);
+    }
+    game->turn = 0;
+    game->winner = -1;
+}
+
+// Releases the computers' strategy state.
+void game_free(Game *game) {
+    for (int i = 0; i < 2; i++) {
+        GamePlayer *player = &game->players[i];
+        if (player->ai && player->ai_state)
+            player->ai->destroy(player->ai_state);
+        player->ai_state = NULL;
+    }
+}
+
+GameStatus game_status(const Game *game) {
+    if (game->winner >= 0)
+        return GAME_OVER;
+    return game->players[game->turn].ai ? GAME_COMPUTER_TURN : GAME_AWAITING_MOVE;
+}
+
+// Ends the game if the player to move has just sunk the last ship, otherwise
+// passes the turn on.
+static void end_turn(Game *game, const GameObserver *observer) {
+    if (check_victory(&game->players[1 - game->turn].fleet)) {
+        game->winner = game->turn;
+        report_victory(observer, game->players[game->turn].name);
+        return;
+    }
+    game->turn = 1 - game->turn;
+}
+
+// A human's shot at (x, y). Nothing changes unless the move is accepted.
+MoveResult game_submit_move(Game *game, int x, int y, const GameObserver *observer) {
+    if (game_status(game) != GAME_AWAITING_MOVE)
+        return MOVE_NOT_ALLOWED;
+    if (x < 0 || y < 0 || x >= BOARD_SIZE || y >= BOARD_SIZE)
+        return MOVE_INVALID;
+    GamePlayer *player = &game->players[game->turn];
+    Board *target = &game->players[1 - game->turn].fleet;
+    if (is_attacked(&player->guess, x, y))
+        return MOVE_REPEATED;
+    AttackResult result = process_attack(target, x, y);
+    record_attack(&player->guess, target, x, y, result);
+    int sunk_size = result == ATTACK_SUNK ? ship_at(target, x, y)->size : 0;
+    report_attack(observer, "You", x, y, result, sunk_size);
+    end_turn(game, observer);
+    return MOVE_ACCEPTED;
+}
+
+// Plays one computer turn if a computer is to move. Returns false when it is
+// a human's move or the game is over, so `while (game_advance(...));` runs
+// the game up to the next human move.
+bool game_advance(Game *game, const GameObserver *observer) {
+    if (game_status(game) != GAME_COMPUTER_TURN)
+        return false;
+    GamePlayer *player = &game->players[game->turn];
+    computer_turn(player->ai, player->ai_state, &game->players[1 - game->turn].fleet,
+                  &player->guess, &game->rng, observer, NULL);
+    end_turn(game, observer);
+    return true;
+}
+
+// Reads a cell written as on the board, e.g. B7. Returns false unless it is
+// exactly a column letter and a row number on the board.
+bool parse_cell(const char *text, int *x, int *y) {
+    char col = text[0];
+    char *end;
+    long row = strtol(text + 1, &end, 10);
+    if (end == text + 1 || *end != '\0')
+        return false;
+    if (row < 1 || row > BOARD_SIZE || col < 'A' || col > 'A' + BOARD_SIZE - 1)
+        return false;
+    *x = (int)row - 1;
+    *y = col - 'A';
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Packed Games
+// -----------------------------------------------------------------------------
+
+static int strategy_index(const Strategy *ai) {
+    for (int i = 0; i < NUM_STRATEGIES; i++)
+        if (STRATEGIES[i] == ai)
+            return i;
+    return -1;
+}
+
+// Squeezes a game into a PackedGame. Both fleets must be complete. Returns
+// false, leaving `packed` alone, if a computer plays a strategy that is not
+// packable or not in STRATEGIES.
+bool game_pack(const Game *game, PackedGame *packed) {
+    for (int p = 0; p < 2; p++) {
+        const Strategy *ai = game->players[p].ai;
+        if (ai && (!ai->packable || strategy_index(ai) < 0))
+            return false;
+    }
+    memset(packed, 0, sizeof(*packed));
+    packed->rng = game->rng;
+    for (int p = 0; p < 2; p++) {
+        const GamePlayer *player = &game->players[p];
+        packed->attacked[p] = bb_or(player->guess.hits, player->guess.misses);
+        for (int i = 0; i < player->fleet.num_ships; i++) {
+            const Ship *ship = &player->fleet.fleet[i];
+            packed->fleets[p][i] = (uint16_t)(cell_index(ship->x, ship->y) << 1 | ship->horizontal);
+        }
+        packed->ai[p] = (unsigned char)(player->ai ? strategy_index(player->ai) + 1 : 0);
+    }
+    packed->turn = (unsigned char)game->turn;
+    packed->winner = (signed char)game->winner;
+    return true;
+}
+
+// Rebuilds the boards, and the computers' strategy state if `strategies` is
+// set. Each side's attacks are replayed in cell order, which gives the same
+// boards as the original order.
+static void unpack(const PackedGame *packed, Game *game, bool strategies) {
+    for (int p = 0; p < 2; p++) {
+        GamePlayer *player = &game->players[p];
+        initialize_board(&player->fleet);
+        initialize_board(&player->guess);
+        for (int i = 0; i < NUM_SHIPS; i++) {
+            int cell = packed->fleets[p][i] >> 1;
+            place_ship(&player->fleet, SHIP_SIZES[i], packed->fleets[p][i] & 1,
+                       cell / BOARD_SIZE, cell % BOARD_SIZE);
+        }
+    }
+    for (int p = 0; p < 2; p++) {
+        GamePlayer *player = &game->players[p];
+        Board *target = &game->players[1 - p].fleet;
+        Bitboard attacked = packed->attacked[p];
+        while (!bb_is_empty(attacked)) {
+            int cell = bb_pop_lowest(&attacked);
+            int x = cell / BOARD_SIZE, y = cell % BOARD_SIZE;
+            AttackResult result = process_attack(target, x, y);
+            record_attack(&player->guess, target, x, y, result);
+            if (strategies && player->ai) {
+                int sunk_size = result == ATTACK_SUNK ? ship_at(target, x, y)->size : 0;
+                player->ai->observe_result(player->ai_state, &player->guess, x, y, result, sunk_size);
+            }
+        }
+    }
+    game->rng = packed->rng;
+    game->turn = packed->turn;
+    game->winner = packed->winner;
+}
+
+// Rebuilds a full game from a PackedGame, naming the players name1 and name2.
+// The computers' strategies observe the replayed results; being packable, they
+// end up in the same state as in the original game. `game` must be zeroed or
+// hold a game: strategy state it already has for the same strategy is reset
+// and reused, so unpacking into one Game again and again does not allocate.
+// Release the game with game_free().
+void game_unpack(const PackedGame *packed, Game *game, const char *name1, const char *name2) {
+    const char *names[2] = { name1, name2 };
+    for (int p = 0; p < 2; p++) {
+        GamePlayer *player = &game->players[p];
+        const Strategy *ai = packed->ai[p] ? STRATEGIES[packed->ai[p] - 1] : NULL;
+        player->name = names[p];
+        if (ai && ai == player->ai && player->ai_state) {
+            ai->reset(player->ai_state);
+        } else {
+            if (player->ai && player->ai_state)
+                player->ai->destroy(player->ai_state);
+            player->ai = ai;
+            player->ai_state = ai ? start_strategy(ai) : NULL;
+        }
+    }
+    unpack(packed, game, true);
+}
+
+// Rebuilds only the boards, turn and winner of a packed game, for showing it.
+// Strategy state is left as it was, so the result must not be advanced; unpack
+// it with game_unpack() before playing on.
+void game_unpack_boards(const PackedGame *packed, Game *game) {
+    unpack(packed, game, false);
+}
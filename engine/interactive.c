@@ -0,0 +1,172 @@
+#include "battleships.h"
+
+// -----------------------------------------------------------------------------
+// Manual Ship Placement
+// -----------------------------------------------------------------------------
+
+void manual_place_ships(Board *board, const char *playerName) {
+    printf("\n%s, place your ships on the board.\n", playerName);
+    for (int i = 0; i < NUM_SHIPS; i++) {
+        int size = SHIP_SIZES[i];
+        bool placed = false;
+        while (!placed) {
+            print_board(board, true);
+            printf("Place your ship of size %d.\n", size);
+            printf("Enter starting coordinate (e.g., A1): ");
+            char coord[5];
+            int x, y;
+            scanf("%4s", coord);
+            if (!parse_cell(coord, &x, &y)) {
+                printf("Invalid coordinate. Try again.\n");
+                continue;
+            }
+            printf("Enter orientation (H for horizontal, V for vertical): ");
+            char orient;
+            scanf(" %c", &orient);
+            bool horizontal;
+            if (orient == 'H' || orient == 'h')
+                horizontal = true;
+            else if (orient == 'V' || orient == 'v')
+                horizontal = false;
+            else {
+                printf("Invalid orientation. Use H or V.\n");
+                continue;
+            }
+            if (!place_ship(board, size, horizontal, x, y)) {
+                printf("Invalid placement or overlapping ship. Try again.\n");
+            } else {
+                placed = true;
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Utility Functions
+// -----------------------------------------------------------------------------
+
+void display_rules() {
+    printf("Welcome to Battleship!\n\n");
+    printf("Game Rules:\n");
+    printf("1. Players take turns attacking each other's ships.\n");
+    printf("2. Ships are placed on a %dx%d grid.\n", BOARD_SIZE, BOARD_SIZE);
+    printf("3. The first player to sink all enemy ships wins.\n\n");
+    printf("Symbols on the Board:\n");
+    printf("  '.' - Water\n");
+    printf("  '&' - Intact ship part\n");
+    printf("  '#' - Hit ship part\n");
+    printf("  '0' - Destroyed ship\n");
+    printf("  'x' - Missed attack\n\n");
+}
+
+void wait_for_enter() {
+    printf("Press Enter to continue...");
+    while(getchar()!='\n'); // flush any leftover newline
+    getchar();
+}
+
+// -----------------------------------------------------------------------------
+// Terminal Observer
+// -----------------------------------------------------------------------------
+
+static void terminal_hit(void *context, const char *shooter, int x, int y) {
+    (void)context;
+    printf("%s HIT at %c%d!\n", shooter, ALPHABET[y], x + 1);
+}
+
+static void terminal_miss(void *context, const char *shooter, int x, int y) {
+    (void)context;
+    printf("%s MISSED at %c%d!\n", shooter, ALPHABET[y], x + 1);
+}
+
+static void terminal_sink(void *context, const char *shooter, int x, int y, int size) {
+    (void)context;
+    (void)x;
+    (void)y;
+    printf("%s sank a ship of size %d!\n", shooter, size);
+}
+
+static void terminal_victory(void *context, const char *winner) {
+    (void)context;
+    printf("%s wins!\n", winner);
+}
+
+const GameObserver TERMINAL_OBSERVER = {
+    NULL, NULL, terminal_hit, terminal_miss, terminal_sink, terminal_victory
+};
+
+// -----------------------------------------------------------------------------
+// Interactive Games
+// -----------------------------------------------------------------------------
+
+// The terminal side of a human's turn: show the boards and ask for a cell until
+// the game accepts one.
+static void human_turn(Game *game) {
+    const GamePlayer *player = &game->players[game->turn];
+    printf("\n--- %s's Turn ---\n", player->name);
+    print_boards(&player->fleet, true, &player->guess, false);
+    while (1) {
+        printf("%s, enter attack coordinates (e.g., A1, A10): ", player->name);
+        char move[5];
+        int x, y;
+        scanf("%4s", move);
+        if (!parse_cell(move, &x, &y)) {
+            printf("Invalid coordinates. Try again.\n");
+            continue;
+        }
+        if (game_submit_move(game, x, y, &TERMINAL_OBSERVER) == MOVE_REPEATED) {
+            printf("Already attacked this position. Try again.\n");
+            continue;
+        }
+        break;
+    }
+}
+
+// A computer's turn, then the board it fired at, pausing before the next turn.
+static void watch_computer_turn(Game *game) {
+    const GamePlayer *player = &game->players[game->turn];
+    const GamePlayer *opponent = &game->players[1 - game->turn];
+    printf("\n--- %s's (%s) Turn ---\n", player->name, player->ai->label);
+    game_advance(game, &TERMINAL_OBSERVER);
+    if (opponent->ai) {
+        printf("%s's board after attack:\n", opponent->name);
+        print_board(&opponent->fleet, false);
+    } else {
+        printf("Your board after computer attack:\n");
+        print_board(&opponent->fleet, true);
+    }
+    if (game_status(game) != GAME_OVER)
+        wait_for_enter();
+}
+
+static void play_game(Game *game) {
+    while (game_status(game) != GAME_OVER) {
+        if (game_status(game) == GAME_AWAITING_MOVE)
+            human_turn(game);
+        else
+            watch_computer_turn(game);
+    }
+    game_free(game);
+}
+
+void play_player_vs_player(void) {
+    Game game;
+    game_init(&game, "Player 1", NULL, "Player 2", NULL, 0);
+    manual_place_ships(&game.players[0].fleet, "Player 1");
+    manual_place_ships(&game.players[1].fleet, "Player 2");
+    play_game(&game);
+}
+
+// The player places ships by hand; the computer's fleet is random.
+void play_player_vs_computer(const Strategy *ai, Rng *rng) {
+    Game game;
+    game_init(&game, "Player", NULL, "Computer", ai, rng_next(rng));
+    manual_place_ships(&game.players[0].fleet, "Player");
+    play_game(&game);
+}
+
+void play_computer_vs_computer(const Strategy *ai1, const Strategy *ai2, Rng *rng) {
+    Game game;
+    game_init(&game, "Computer 1", ai1, "Computer 2", ai2, rng_next(rng));
+    play_game(&game);
+}
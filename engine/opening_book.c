@@ -0,0 +1,23 @@
+#include "battleships.h"
+
+// -----------------------------------------------------------------------------
+// Opening Books
+// -----------------------------------------------------------------------------
+
+// Generated with --write-opening-book 24 by the build for each board size; a custom
+// game with the same board and fleet uses the same book. Regenerate them
+// whenever the nightmare AI's hunting changes, or the books will no longer
+// match its live choices (--no-book and --replay show the difference).
+const OpeningBook OPENING_BOOKS[] = {
+    // 10x10: 5,3,2,2,1
+    { 10, 5, { 5, 3, 2, 2, 1 }, 24,
+      { 44, 55, 33, 66, 22, 27, 72, 77, 15, 38, 51, 83, 49, 88, 94, 4, 36, 40, 63, 11, 47, 58, 74, 85 } },
+    // 12x12: 6,5,4,3,3,2,2,1
+    { 12, 8, { 6, 5, 4, 3, 3, 2, 2, 1 }, 24,
+      { 65, 78, 52, 91, 39, 104, 31, 44, 57, 86, 99, 112, 18, 70, 73, 125, 26, 117, 5, 60, 83, 138, 13, 130 } },
+    // 16x16: 7,6,5,5,4,4,3,3,2,2,1
+    { 16, 11, { 7, 6, 5, 5, 4, 4, 3, 3, 2, 2, 1 }, 24,
+      { 102, 119, 136, 153, 85, 170, 74, 91, 164, 181, 57, 68, 108, 147, 187, 198, 40, 125, 130, 215, 51, 204, 23, 113 } },
+};
+
+const int NUM_OPENING_BOOKS = sizeof(OPENING_BOOKS) / sizeof(OPENING_BOOKS[0]);
@@ -0,0 +1,66 @@
+#include "battleships.h"
+
+// -----------------------------------------------------------------------------
+// Object Pool
+// -----------------------------------------------------------------------------
+
+// Objects are carved out of slabs, and freed objects go on an intrusive free
+// list, so once the pool has grown to its peak, allocating costs two pointer
+// moves and never calls malloc. Slabs are only returned by pool_destroy().
+typedef struct Slab {
+    struct Slab *next;
+} Slab;
+
+void pool_init(Pool *pool, size_t object_size, int per_slab) {
+    // Every object must be able to hold the free list link, suitably aligned.
+    size_t align = sizeof(void *) > sizeof(uint64_t) ? sizeof(void *) : sizeof(uint64_t);
+    if (object_size < sizeof(void *))
+        object_size = sizeof(void *);
+    pool->object_size = (object_size + align - 1) / align * align;
+    pool->per_slab = per_slab > 0 ? per_slab : 1;
+    pool->free_list = NULL;
+    pool->slabs = NULL;
+    pool->in_use = 0;
+    pool->capacity = 0;
+}
+
+// Returns a zeroed object, or NULL if a new slab could not be allocated.
+void *pool_alloc(Pool *pool) {
+    if (!pool->free_list) {
+        size_t header = (sizeof(Slab) + pool->object_size - 1) / pool->object_size * pool->object_size;
+        Slab *slab = malloc(header + pool->object_size * (size_t)pool->per_slab);
+        if (!slab)
+            return NULL;
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        char *objects = (char *)slab + header;
+        for (int i = pool->per_slab - 1; i >= 0; i--) {
+            void **object = (void **)(objects + pool->object_size * (size_t)i);
+            *object = pool->free_list;
+            pool->free_list = object;
+        }
+        pool->capacity += pool->per_slab;
+    }
+    void **object = pool->free_list;
+    pool->free_list = *object;
+    pool->in_use++;
+    memset(object, 0, pool->object_size);
+    return object;
+}
+
+void pool_free(Pool *pool, void *object) {
+    *(void **)object = pool->free_list;
+    pool->free_list = object;
+    pool->in_use--;
+}
+
+void pool_destroy(Pool *pool) {
+    while (pool->slabs) {
+        Slab *next = pool->slabs->next;
+        free(pool->slabs);
+        pool->slabs = next;
+    }
+    pool->free_list = NULL;
+    pool->in_use = 0;
+    pool->capacity = 0;
+}
@@ -0,0 +1,131 @@
+#include <unistd.h>
+#include "battleships.h"
+
+// -----------------------------------------------------------------------------
+// Board Rendering
+// -----------------------------------------------------------------------------
+
+bool ansi_colour = false;
+
+#define COLOUR_SHIP  "\033[32m"    // Intact ship.
+#define COLOUR_HIT   "\033[1;31m"  // Hit.
+#define COLOUR_SUNK  "\033[35m"    // Sunk.
+#define COLOUR_MISS  "\033[34m"    // Miss.
+#define COLOUR_RESET "\033[0m"
+
+// Boards are formatted into one buffer and written with a single write(), since
+// on slow remote terminals every small write costs a round trip. Cells take at
+// most RENDER_CELL_MAX bytes: the longest colour escape, symbol, reset, space.
+#define RENDER_CELL_MAX (sizeof(COLOUR_HIT) - 1 + 1 + sizeof(COLOUR_RESET) - 1 + 1)
+_Static_assert(sizeof(COLOUR_HIT) >= sizeof(COLOUR_SHIP) && sizeof(COLOUR_HIT) >= sizeof(COLOUR_SUNK) &&
+               sizeof(COLOUR_HIT) >= sizeof(COLOUR_MISS), "RENDER_CELL_MAX expects the hit colour to be the longest");
+#define RENDER_LINE_MAX (2 * (8 + MAX_BOARD_SIZE * RENDER_CELL_MAX) + 8)
+
+typedef struct {
+    char data[(MAX_BOARD_SIZE + 2) * RENDER_LINE_MAX];
+    size_t length;
+} RenderBuffer;
+
+static void render_text(RenderBuffer *out, const char *text) {
+    size_t n = strlen(text);
+    memcpy(out->data + out->length, text, n);
+    out->length += n;
+}
+
+static void render_char(RenderBuffer *out, char c) {
+    out->data[out->length++] = c;
+}
+
+static const char *cell_colour(char symbol) {
+    switch (symbol) {
+    case '&': return COLOUR_SHIP;
+    case '#': return COLOUR_HIT;
+    case '0': return COLOUR_SUNK;
+    case 'x': return COLOUR_MISS;
+    default:  return NULL;
+    }
+}
+
+static void render_header(RenderBuffer *out) {
+    render_text(out, "   ");
+    for (int j = 0; j < BOARD_SIZE; j++) {
+        if (j > 0)
+            render_char(out, ' ');
+        render_char(out, ALPHABET[j]);
+    }
+}
+
+static void render_divider(RenderBuffer *out) {
+    render_text(out, "  ");
+    for (int j = 0; j < 2 * BOARD_SIZE + 1; j++)
+        render_char(out, '-');
+}
+
+static void render_row(RenderBuffer *out, const Board *board, int i, bool reveal_ships) {
+    char label[16];
+    snprintf(label, sizeof(label), "%2d| ", i + 1);
+    render_text(out, label);
+    for (int j = 0; j < BOARD_SIZE; j++) {
+        char cell = board_symbol(board, i, j);
+        // In hidden mode, intact ships are not shown.
+        if (cell == '&' && !reveal_ships)
+            cell = '.';
+        const char *colour = ansi_colour ? cell_colour(cell) : NULL;
+        if (colour)
+            render_text(out, colour);
+        render_char(out, cell);
+        if (colour)
+            render_text(out, COLOUR_RESET);
+        render_char(out, ' ');
+    }
+}
+
+// Writes the buffer to stdout after anything printf() still holds.
+static void render_flush(const RenderBuffer *out) {
+    fflush(stdout);
+    size_t written = 0;
+    while (written < out->length) {
+        ssize_t n = write(STDOUT_FILENO, out->data + written, out->length - written);
+        if (n <= 0)
+            break;
+        written += (size_t)n;
+    }
+}
+
+void print_board(const Board *board, bool reveal_ships) {
+    RenderBuffer out;
+    out.length = 0;
+    render_header(&out);
+    render_char(&out, '\n');
+    render_divider(&out);
+    render_char(&out, '\n');
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        render_row(&out, board, i, reveal_ships);
+        render_char(&out, '\n');
+    }
+    render_flush(&out);
+}
+
+// Prints two boards next to each other, e.g. a player's own fleet and their
+// guesses on the opponent.
+void print_boards(const Board *left, bool reveal_left, const Board *right, bool reveal_right) {
+    RenderBuffer out;
+    out.length = 0;
+    // Rows are two characters wider than the header and one wider than the
+    // divider, so those get extra padding to keep the right board aligned.
+    render_header(&out);
+    render_text(&out, "      ");
+    render_header(&out);
+    render_char(&out, '\n');
+    render_divider(&out);
+    render_text(&out, "     ");
+    render_divider(&out);
+    render_char(&out, '\n');
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        render_row(&out, left, i, reveal_left);
+        render_text(&out, "    ");
+        render_row(&out, right, i, reveal_right);
+        render_char(&out, '\n');
+    }
+    render_flush(&out);
+}
@@ -0,0 +1,529 @@
+#include <pthread.h>
+#include <unistd.h>
+#include "battleships.h"
+
+static void write_log_header(FILE *out, uint64_t seed, const Strategy *ai1, const Strategy *ai2);
+static void write_game_record(FILE *out, long game, const GameRecord *record);
+
+// -----------------------------------------------------------------------------
+// Batch Statistics
+// -----------------------------------------------------------------------------
+
+void stats_add_game(GameStats *stats, const GameRecord *record, GameResult result) {
+    int first_hit[2] = { 0, 0 };
+    for (int n = 0; n < record->num_shots; n++) {
+        int player = n & 1;
+        if ((record->shots[n] & 3) == ATTACK_MISS)
+            continue;
+        stats->hits[player][record->shots[n] >> 2]++;
+        if (first_hit[player] == 0)
+            first_hit[player] = n / 2 + 1;
+    }
+    stats->games++;
+    stats->wins[result.winner - 1]++;
+    stats->winner_shots += result.winner_shots;
+    stats->shots_to_win[result.winner - 1][result.winner_shots]++;
+    stats->first_hit[0][first_hit[0]]++;
+    stats->first_hit[1][first_hit[1]]++;
+}
+
+void stats_merge(GameStats *into, const GameStats *from) {
+    into->games += from->games;
+    into->winner_shots += from->winner_shots;
+    for (int p = 0; p < 2; p++) {
+        into->wins[p] += from->wins[p];
+        for (int n = 0; n <= BOARD_CELLS; n++) {
+            into->shots_to_win[p][n] += from->shots_to_win[p][n];
+            into->first_hit[p][n] += from->first_hit[p][n];
+        }
+        for (int cell = 0; cell < BOARD_CELLS; cell++)
+            into->hits[p][cell] += from->hits[p][cell];
+    }
+}
+
+// Mean of a histogram indexed by shot number, leaving out bucket 0.
+static double histogram_mean(const long *histogram) {
+    long count = 0;
+    double sum = 0;
+    for (int n = 1; n <= BOARD_CELLS; n++) {
+        count += histogram[n];
+        sum += (double)n * histogram[n];
+    }
+    return count > 0 ? sum / count : 0.0;
+}
+
+// CSV snapshots are one row per snapshot. The histogram columns are named by
+// shot number and the heatmap columns by cell, with one set per player.
+void stats_write_csv_header(FILE *out) {
+    fprintf(out, "games,elapsed_s");
+    for (int p = 1; p <= 2; p++) {
+        fprintf(out, ",p%d_wins,p%d_mean_shots_to_win,p%d_mean_first_hit", p, p, p);
+        for (int n = 1; n <= BOARD_CELLS; n++)
+            fprintf(out, ",p%d_shots_to_win_%d", p, n);
+        for (int n = 0; n <= BOARD_CELLS; n++)
+            fprintf(out, ",p%d_first_hit_%d", p, n);
+        for (int cell = 0; cell < BOARD_CELLS; cell++)
+            fprintf(out, ",p%d_hits_%c%d", p, ALPHABET[cell % BOARD_SIZE], cell / BOARD_SIZE + 1);
+    }
+    fprintf(out, "\n");
+}
+
+static void write_counts(FILE *out, const long *counts, int n, bool json) {
+    for (int i = 0; i < n; i++)
+        fprintf(out, json ? (i ? ",%ld" : "%ld") : ",%ld", counts[i]);
+}
+
+// Writes the running totals as one CSV row or JSON line and flushes it, so the
+// file can be followed while the batch is still running.
+void stats_write_snapshot(FILE *out, const GameStats *stats, double elapsed, bool json) {
+    if (json)
+        fprintf(out, "{\"games\":%ld,\"elapsed_s\":%.3f,\"players\":[", stats->games, elapsed);
+    else
+        fprintf(out, "%ld,%.3f", stats->games, elapsed);
+    for (int p = 0; p < 2; p++) {
+        double mean_shots = histogram_mean(stats->shots_to_win[p]);
+        double mean_first_hit = histogram_mean(stats->first_hit[p]);
+        if (json) {
+            fprintf(out, "%s{\"wins\":%ld,\"mean_shots_to_win\":%.3f,\"mean_first_hit\":%.3f,\"shots_to_win\":[",
+                    p ? "," : "", stats->wins[p], mean_shots, mean_first_hit);
+            write_counts(out, stats->shots_to_win[p] + 1, BOARD_CELLS, true);
+            fprintf(out, "],\"first_hit\":[");
+            write_counts(out, stats->first_hit[p], BOARD_CELLS + 1, true);
+            fprintf(out, "],\"hits\":[");
+            write_counts(out, stats->hits[p], BOARD_CELLS, true);
+            fprintf(out, "]}");
+        } else {
+            fprintf(out, ",%ld,%.3f,%.3f", stats->wins[p], mean_shots, mean_first_hit);
+            write_counts(out, stats->shots_to_win[p] + 1, BOARD_CELLS, false);
+            write_counts(out, stats->first_hit[p], BOARD_CELLS + 1, false);
+            write_counts(out, stats->hits[p], BOARD_CELLS, false);
+        }
+    }
+    fprintf(out, json ? "]}\n" : "\n");
+    fflush(out);
+}
+
+// -----------------------------------------------------------------------------
+// Headless Batch Simulation
+// -----------------------------------------------------------------------------
+
+static void record_fleet(uint16_t *fleet, const Board *board) {
+    for (int i = 0; i < board->num_ships; i++) {
+        const Ship *ship = &board->fleet[i];
+        fleet[i] = (uint16_t)(cell_index(ship->x, ship->y) << 1 | ship->horizontal);
+    }
+}
+
+// Plays one full computer vs computer game on random fleets without any output.
+// The game is recorded in `record` unless it is NULL. ai_state1 and ai_state2
+// come from start_strategy() and are reset here, so a caller playing many games
+// allocates them once.
+GameResult simulate_game(const Strategy *ai1, void *ai_state1, const Strategy *ai2, void *ai_state2,
+                         Rng *rng, GameRecord *record) {
+    Board comp1_board, comp2_board, comp1_guess, comp2_guess;
+    initialize_board(&comp1_board);
+    initialize_board(&comp2_board);
+    initialize_board(&comp1_guess);
+    initialize_board(&comp2_guess);
+    place_ships_random(&comp1_board, rng);
+    place_ships_random(&comp2_board, rng);
+
+    if (record) {
+        record_fleet(record->fleets[0], &comp1_board);
+        record_fleet(record->fleets[1], &comp2_board);
+        record->num_shots = 0;
+    }
+
+    ai1->reset(ai_state1);
+    ai2->reset(ai_state2);
+
+    GameResult result = { 0, 0 };
+    int shots = 0, cell;
+    AttackResult outcome;
+    while (true) {
+        shots++;
+        outcome = computer_turn(ai1, ai_state1, &comp2_board, &comp1_guess, rng, NULL, &cell);
+        if (record)
+            record->shots[record->num_shots++] = (uint16_t)(cell << 2 | outcome);
+        if (check_victory(&comp2_board)) {
+            result.winner = 1;
+            break;
+        }
+        outcome = computer_turn(ai2, ai_state2, &comp1_board, &comp2_guess, rng, NULL, &cell);
+        if (record)
+            record->shots[record->num_shots++] = (uint16_t)(cell << 2 | outcome);
+        if (check_victory(&comp1_board)) {
+            result.winner = 2;
+            break;
+        }
+    }
+    result.winner_shots = shots;
+    return result;
+}
+
+// Per-worker slice of a tournament. Each worker writes only its own slot, so the
+// totals are combined after pthread_join without any locking. The padding keeps
+// neighbouring workers' counters off the same cache line.
+typedef struct {
+    long first_game;
+    long num_games;
+    uint64_t seed;
+    const Strategy *ai[2];
+    FILE *log;  // Records of this worker's games, or NULL.
+    GameStats stats;
+    char padding[64];
+} TournamentWorker;
+
+// Games are seeded by their index, so results do not depend on the thread count.
+static uint64_t game_seed(uint64_t seed, long game) {
+    Rng rng;
+    rng_seed(&rng, seed ^ ((uint64_t)game * 0xD1B54A32D192ED03ULL));
+    return rng_next(&rng);
+}
+
+static void *tournament_worker(void *arg) {
+    TournamentWorker *worker = arg;
+    Rng rng;
+    GameRecord record;
+    void *ai_state[2] = { start_strategy(worker->ai[0]), start_strategy(worker->ai[1]) };
+    for (long g = 0; g < worker->num_games; g++) {
+        rng_seed(&rng, game_seed(worker->seed, worker->first_game + g));
+        GameResult result = simulate_game(worker->ai[0], ai_state[0], worker->ai[1], ai_state[1],
+                                          &rng, &record);
+        if (worker->log)
+            write_game_record(worker->log, worker->first_game + g, &record);
+        stats_add_game(&worker->stats, &record, result);
+    }
+    worker->ai[0]->destroy(ai_state[0]);
+    worker->ai[1]->destroy(ai_state[1]);
+    return NULL;
+}
+
+int default_thread_count() {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
+
+double elapsed_seconds(const struct timespec *start, const struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Plays config->games games split across the worker threads and prints a summary
+// of the results. Games are played in rounds of config->stats_every games when a
+// statistics file is given, and a snapshot of the running totals is appended
+// after each round. With a log path, every game is also written to that game
+// log; each worker logs a round to its own temporary file and these are joined
+// in game order.
+int run_batch(const BatchConfig *config) {
+    long games = config->games;
+    int threads = config->threads;
+    if (threads <= 0)
+        threads = default_thread_count();
+    if (threads > games)
+        threads = (int)games;
+    // Games already run in parallel; the exact AI samples on its game's thread.
+    if (exact_config.threads <= 0)
+        exact_config.threads = 1;
+    // A logged game must replay shot for shot, so the exact AI may only stop
+    // sampling at its sample limit, never at the wall-clock budget.
+    bool exact_logged = config->log_path && (config->ai[0] == &EXACT_STRATEGY || config->ai[1] == &EXACT_STRATEGY);
+    if (exact_logged && exact_config.max_samples <= 0) {
+        fprintf(stderr, "Logging exact AI games needs --exact-samples: games cut off by the\n"
+                        "wall-clock budget cannot be replayed.\n");
+        return 1;
+    }
+    if (exact_logged)
+        exact_config.budget_ms = 0;
+
+    TournamentWorker *workers = calloc(threads, sizeof(TournamentWorker));
+    pthread_t *handles = calloc(threads, sizeof(pthread_t));
+    GameStats *totals = calloc(1, sizeof(GameStats));
+    if (!workers || !handles || !totals) {
+        fprintf(stderr, "Out of memory.\n");
+        free(workers);
+        free(handles);
+        free(totals);
+        return 1;
+    }
+    FILE *log = NULL, *stats_out = NULL;
+    bool failed = false;
+    if (config->log_path && !(log = fopen(config->log_path, "wb"))) {
+        fprintf(stderr, "Cannot write game log %s.\n", config->log_path);
+        failed = true;
+    }
+    if (config->stats_path && !(stats_out = fopen(config->stats_path, "w"))) {
+        fprintf(stderr, "Cannot write statistics file %s.\n", config->stats_path);
+        failed = true;
+    }
+    if (log)
+        write_log_header(log, config->seed, config->ai[0], config->ai[1]);
+    if (stats_out && !config->stats_json)
+        stats_write_csv_header(stats_out);
+    long round_games = stats_out && config->stats_every > 0 ? config->stats_every : games;
+
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    for (long done = 0; done < games && !failed; done += round_games) {
+        long round = games - done < round_games ? games - done : round_games;
+        long next_game = done;
+        for (int t = 0; t < threads; t++) {
+            workers[t].first_game = next_game;
+            workers[t].num_games = round / threads + (t < round % threads ? 1 : 0);
+            workers[t].seed = config->seed;
+            workers[t].ai[0] = config->ai[0];
+            workers[t].ai[1] = config->ai[1];
+            memset(&workers[t].stats, 0, sizeof(workers[t].stats));
+            next_game += workers[t].num_games;
+            if (log && !(workers[t].log = tmpfile())) {
+                fprintf(stderr, "Cannot create a temporary file for the game log.\n");
+                failed = true;
+            }
+        }
+        for (int t = 0; t < threads && !failed; t++) {
+            if (pthread_create(&handles[t], NULL, tournament_worker, &workers[t]) != 0) {
+                // Fall back to running this slice on the calling thread.
+                tournament_worker(&workers[t]);
+                handles[t] = 0;
+            }
+        }
+        for (int t = 0; t < threads && !failed; t++) {
+            if (handles[t])
+                pthread_join(handles[t], NULL);
+            stats_merge(totals, &workers[t].stats);
+        }
+        timespec_get(&end, TIME_UTC);
+        for (int t = 0; t < threads; t++) {
+            if (!workers[t].log)
+                continue;
+            char buffer[1 << 16];
+            size_t n;
+            rewind(workers[t].log);
+            while (!failed && (n = fread(buffer, 1, sizeof(buffer), workers[t].log)) > 0)
+                fwrite(buffer, 1, n, log);
+            failed |= ferror(workers[t].log) != 0 || ferror(log) != 0;
+            fclose(workers[t].log);
+            workers[t].log = NULL;
+        }
+        if (stats_out) {
+            stats_write_snapshot(stats_out, totals, elapsed_seconds(&start, &end), config->stats_json);
+            failed |= ferror(stats_out) != 0;
+        }
+    }
+    timespec_get(&end, TIME_UTC);
+    if (log && fclose(log) != 0)
+        failed = true;
+    if (stats_out && fclose(stats_out) != 0)
+        failed = true;
+
+    double seconds = elapsed_seconds(&start, &end);
+    if (!failed) {
+        printf("Games played:        %ld\n", games);
+        printf("Threads:             %d\n", threads);
+        printf("Seed:                %llu\n", (unsigned long long)config->seed);
+        printf("Computer 1 (%s) wins: %ld (%.2f%%)\n", config->ai[0]->name, totals->wins[0], 100.0 * totals->wins[0] / games);
+        printf("Computer 2 (%s) wins: %ld (%.2f%%)\n", config->ai[1]->name, totals->wins[1], 100.0 * totals->wins[1] / games);
+        printf("Avg shots to win:    %.2f\n", (double)totals->winner_shots / games);
+        printf("Elapsed:             %.3f s\n", seconds);
+        printf("Games/second:        %.1f\n", seconds > 0 ? games / seconds : 0.0);
+    } else if (log || stats_out) {
+        fprintf(stderr, "Batch stopped: could not write its output files.\n");
+    }
+    free(workers);
+    free(handles);
+    free(totals);
+    return failed ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Game Logs
+// -----------------------------------------------------------------------------
+
+// A log is a header followed by one record per game, all integers little-endian:
+//   "BSLG" version:u8 board_size:u8 num_ships:u8 ship_sizes:u8[num_ships]
+//   seed:u64 (name_length:u8 name)[2] parity:u8 exact_samples:u32 exact_threads:u8
+//   per game: index:u32 fleets:u16[2][num_ships] num_shots:u16 shots:u16[num_shots]
+// Each game's generator is seeded from the batch seed and the game's index, so
+// any record can be replayed on its own. The header also holds the settings that
+// change how the AIs play (--no-parity, and the exact AI's sample limit and
+// threads), which a replay applies before playing the games again.
+#define LOG_MAGIC "BSLG"
+#define LOG_VERSION 2
+
+static void put_bytes(FILE *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++)
+        fputc((int)(value >> (8 * i) & 0xFF), out);
+}
+
+static bool get_bytes(FILE *in, uint64_t *value, int bytes) {
+    *value = 0;
+    for (int i = 0; i < bytes; i++) {
+        int c = fgetc(in);
+        if (c == EOF)
+            return false;
+        *value |= (uint64_t)c << (8 * i);
+    }
+    return true;
+}
+
+static void write_log_header(FILE *out, uint64_t seed, const Strategy *ai1, const Strategy *ai2) {
+    fputs(LOG_MAGIC, out);
+    put_bytes(out, LOG_VERSION, 1);
+    put_bytes(out, BOARD_SIZE, 1);
+    put_bytes(out, NUM_SHIPS, 1);
+    for (int i = 0; i < NUM_SHIPS; i++)
+        put_bytes(out, SHIP_SIZES[i], 1);
+    put_bytes(out, seed, 8);
+    const Strategy *ai[2] = { ai1, ai2 };
+    for (int p = 0; p < 2; p++) {
+        size_t length = strlen(ai[p]->name);
+        put_bytes(out, length, 1);
+        fwrite(ai[p]->name, 1, length, out);
+    }
+    put_bytes(out, standard_parity, 1);
+    put_bytes(out, (uint64_t)exact_config.max_samples, 4);
+    put_bytes(out, (uint64_t)exact_config.threads, 1);
+}
+
+// Reads a header written for this board and fleet and applies its AI settings;
+// false if it is anything else.
+static bool read_log_header(FILE *in, uint64_t *seed, const Strategy *ai[2]) {
+    char magic[4];
+    uint64_t value;
+    if (fread(magic, 1, 4, in) != 4 || memcmp(magic, LOG_MAGIC, 4) != 0)
+        return false;
+    if (!get_bytes(in, &value, 1) || value != LOG_VERSION)
+        return false;
+    if (!get_bytes(in, &value, 1) || value != (uint64_t)BOARD_SIZE)
+        return false;
+    if (!get_bytes(in, &value, 1) || value != (uint64_t)NUM_SHIPS)
+        return false;
+    for (int i = 0; i < NUM_SHIPS; i++)
+        if (!get_bytes(in, &value, 1) || value != (uint64_t)SHIP_SIZES[i])
+            return false;
+    if (!get_bytes(in, seed, 8))
+        return false;
+    for (int p = 0; p < 2; p++) {
+        char name[256];
+        if (!get_bytes(in, &value, 1) || fread(name, 1, value, in) != value)
+            return false;
+        name[value] = '\0';
+        if (!(ai[p] = find_strategy(name)))
+            return false;
+    }
+    uint64_t parity, samples, threads;
+    if (!get_bytes(in, &parity, 1) || !get_bytes(in, &samples, 4) || !get_bytes(in, &threads, 1))
+        return false;
+    standard_parity = parity != 0;
+    exact_config.max_samples = (long)samples;
+    exact_config.threads = (int)threads;
+    exact_config.budget_ms = 0;
+    return true;
+}
+
+static void write_game_record(FILE *out, long game, const GameRecord *record) {
+    put_bytes(out, (uint64_t)game, 4);
+    for (int p = 0; p < 2; p++)
+        for (int i = 0; i < NUM_SHIPS; i++)
+            put_bytes(out, record->fleets[p][i], 2);
+    put_bytes(out, record->num_shots, 2);
+    for (int n = 0; n < record->num_shots; n++)
+        put_bytes(out, record->shots[n], 2);
+}
+
+// Returns 1 for a record, 0 at the end of the log and -1 if the record is
+// truncated or corrupt.
+static int read_game_record(FILE *in, long *game, GameRecord *record) {
+    uint64_t value;
+    int c = fgetc(in);
+    if (c == EOF)
+        return 0;
+    ungetc(c, in);
+    if (!get_bytes(in, &value, 4))
+        return -1;
+    *game = (long)value;
+    for (int p = 0; p < 2; p++) {
+        for (int i = 0; i < NUM_SHIPS; i++) {
+            if (!get_bytes(in, &value, 2))
+                return -1;
+            record->fleets[p][i] = (uint16_t)value;
+        }
+    }
+    if (!get_bytes(in, &value, 2) || value > 2 * BOARD_CELLS)
+        return -1;
+    record->num_shots = (int)value;
+    for (int n = 0; n < record->num_shots; n++) {
+        if (!get_bytes(in, &value, 2))
+            return -1;
+        record->shots[n] = (uint16_t)value;
+    }
+    return 1;
+}
+
+// Index of the first shot where two games part ways, 0 for different fleets, or
+// -1 if they are identical.
+static int first_difference(const GameRecord *a, const GameRecord *b) {
+    // Only the first NUM_SHIPS slots are filled; the rest may be garbage on the
+    // runtime board.
+    for (int p = 0; p < 2; p++)
+        if (memcmp(a->fleets[p], b->fleets[p], NUM_SHIPS * sizeof(a->fleets[p][0])) != 0)
+            return 0;
+    for (int n = 0; n < a->num_shots || n < b->num_shots; n++)
+        if (n >= a->num_shots || n >= b->num_shots || a->shots[n] != b->shots[n])
+            return n + 1;
+    return -1;
+}
+
+// Re-plays every game in a log from its seed and checks that fleets, shots and
+// results come out exactly as logged. Returns non-zero if any game differs.
+int run_replay(const char *log_path) {
+    FILE *in = fopen(log_path, "rb");
+    if (!in) {
+        fprintf(stderr, "Cannot open %s.\n", log_path);
+        return 1;
+    }
+    uint64_t seed;
+    const Strategy *ai[2];
+    if (!read_log_header(in, &seed, ai)) {
+        fprintf(stderr, "%s is not a game log for this board, fleet and set of strategies.\n", log_path);
+        fclose(in);
+        return 1;
+    }
+
+    long games = 0, mismatches = 0, game;
+    int status;
+    GameRecord logged, replayed;
+    Rng rng;
+    void *ai_state[2] = { start_strategy(ai[0]), start_strategy(ai[1]) };
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    while ((status = read_game_record(in, &game, &logged)) > 0) {
+        rng_seed(&rng, game_seed(seed, game));
+        simulate_game(ai[0], ai_state[0], ai[1], ai_state[1], &rng, &replayed);
+        games++;
+        int diff = first_difference(&logged, &replayed);
+        if (diff >= 0 && mismatches++ == 0) {
+            if (diff == 0)
+                printf("First mismatch: game %ld places different fleets.\n", game);
+            else
+                printf("First mismatch: game %ld, shot %d.\n", game, diff);
+        }
+    }
+    bool truncated = status < 0;
+    timespec_get(&end, TIME_UTC);
+    fclose(in);
+    ai[0]->destroy(ai_state[0]);
+    ai[1]->destroy(ai_state[1]);
+
+    double seconds = elapsed_seconds(&start, &end);
+    printf("Games replayed:      %ld (%s vs %s)\n", games, ai[0]->name, ai[1]->name);
+    printf("Mismatches:          %ld\n", mismatches);
+    if (truncated)
+        printf("The log ends with a truncated or corrupt record.\n");
+    printf("Elapsed:             %.3f s\n", seconds);
+    printf("Games/second:        %.1f\n", seconds > 0 ? games / seconds : 0.0);
+    return mismatches > 0 || truncated;
+}
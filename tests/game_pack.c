@@ -0,0 +1,107 @@
+#include "battleships.h"
+
+// -----------------------------------------------------------------------------
+// Pack Round Trip
+// -----------------------------------------------------------------------------
+
+// Plays every strategy in STRATEGIES twice in lockstep: once as a plain Game,
+// once packed and unpacked again into the same Game before every move, as the
+// server does. Packable strategies must play the same game both ways, and
+// game_unpack_boards() must show the same boards; the others must be refused by
+// game_pack().
+
+static int failures;
+
+static void fail(const char *strategy, const char *what, int move) {
+    fprintf(stderr, "%s: %s after move %d\n", strategy, what, move);
+    failures++;
+}
+
+static bool boards_equal(const Board *a, const Board *b) {
+    return bb_equal(a->ships, b->ships) && bb_equal(a->hits, b->hits) &&
+           bb_equal(a->misses, b->misses) && bb_equal(a->sunk, b->sunk) &&
+           a->intact_cells == b->intact_cells;
+}
+
+static bool games_equal(const Game *a, const Game *b) {
+    for (int p = 0; p < 2; p++)
+        if (!boards_equal(&a->players[p].fleet, &b->players[p].fleet) ||
+            !boards_equal(&a->players[p].guess, &b->players[p].guess))
+            return false;
+    return a->turn == b->turn && a->winner == b->winner &&
+           memcmp(&a->rng, &b->rng, sizeof(a->rng)) == 0;
+}
+
+// A human who fires at the first cell they have not attacked yet.
+static void first_open_cell(const Board *guess, int *x, int *y) {
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        if (!is_attacked(guess, cell / BOARD_SIZE, cell % BOARD_SIZE)) {
+            *x = cell / BOARD_SIZE;
+            *y = cell % BOARD_SIZE;
+            return;
+        }
+    }
+}
+
+// Player 1 is human when `human` is set, as on the server; otherwise both
+// players are computers using `ai`.
+static void round_trip(const Strategy *ai, bool human, uint64_t seed) {
+    Game plain, packed_game, shown = { 0 };
+    PackedGame packed;
+    const Strategy *first = human ? NULL : ai;
+    game_init(&plain, "One", first, "Two", ai, seed);
+    game_init(&packed_game, "One", first, "Two", ai, seed);
+    if (human) {
+        place_ships_random(&plain.players[0].fleet, &plain.rng);
+        place_ships_random(&packed_game.players[0].fleet, &packed_game.rng);
+    }
+    if (!ai->packable) {
+        if (game_pack(&packed_game, &packed))
+            fail(ai->name, "packed an order-dependent strategy", 0);
+        game_free(&plain);
+        game_free(&packed_game);
+        return;
+    }
+    for (int move = 1; game_status(&plain) != GAME_OVER; move++) {
+        if (!game_pack(&packed_game, &packed)) {
+            fail(ai->name, "game_pack() refused the game", move);
+            break;
+        }
+        game_unpack(&packed, &packed_game, "One", "Two");
+        game_unpack_boards(&packed, &shown);
+        if (!games_equal(&shown, &packed_game)) {
+            fail(ai->name, "game_unpack_boards() differs from game_unpack()", move);
+            break;
+        }
+        if (game_status(&plain) == GAME_AWAITING_MOVE) {
+            int x = 0, y = 0;
+            first_open_cell(&plain.players[plain.turn].guess, &x, &y);
+            game_submit_move(&plain, x, y, NULL);
+            game_submit_move(&packed_game, x, y, NULL);
+        } else {
+            game_advance(&plain, NULL);
+            game_advance(&packed_game, NULL);
+        }
+        if (!games_equal(&plain, &packed_game)) {
+            fail(ai->name, human ? "player vs computer games differ" : "computer games differ", move);
+            break;
+        }
+    }
+    game_free(&plain);
+    game_free(&packed_game);
+}
+
+int main(void) {
+    engine_init();
+    // Exact AI moves must not depend on the wall clock or on thread timing.
+    exact_config = (ExactConfig){ 0, 200, 1 };
+    for (int i = 0; i < NUM_STRATEGIES; i++) {
+        for (uint64_t seed = 1; seed <= 3; seed++) {
+            round_trip(STRATEGIES[i], true, seed);
+            round_trip(STRATEGIES[i], false, seed);
+        }
+    }
+    if (failures == 0)
+        printf("Pack round trip: %d strategies OK\n", NUM_STRATEGIES);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+# Plays a logged batch with PROGRAM and replays the log, which must match.
+# ARGS holds extra options for both runs, separated by '|'.
+string(REPLACE "|" ";" ARGS "${ARGS}")
+set(LOG "${CMAKE_CURRENT_BINARY_DIR}/${NAME}.bin")
+
+execute_process(COMMAND "${PROGRAM}" ${ARGS} --batch 200 --seed 3 --threads 2 --log "${LOG}"
+                RESULT_VARIABLE result OUTPUT_QUIET)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "--batch failed: ${result}")
+endif()
+
+execute_process(COMMAND "${PROGRAM}" ${ARGS} --replay "${LOG}"
+                RESULT_VARIABLE result OUTPUT_VARIABLE output)
+file(REMOVE "${LOG}")
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "--replay reported differences:\n${output}")
+endif()